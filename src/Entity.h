@@ -2,6 +2,8 @@
 
 #include <ecs/entity_id.h>
 
+#include <cstdint>
+
 namespace Core
 {
 	// don't you just love forward declares!
@@ -10,6 +12,8 @@ namespace Core
 	namespace detail
 	{
 		inline ecs::entity_id AccessECSID(EntityID);
+		bool IsCurrentGeneration(EntityID);
+		std::uint32_t GetCurrentGeneration(std::uint32_t _index);
 	}
 
 	class EntityID
@@ -17,26 +21,49 @@ namespace Core
 	public:
 		using CoreType = ecs::entity_id;
 
+		// The ecs runtime only sees the index, which is reused once an entity is destroyed, so its component pools stay dense.
+		// The generation is bumped on every reuse so stale handles can be told apart. It's only kept in the handle, and checked against the generation table.
+		static constexpr std::uint32_t c_indexBits = 24;
+		static constexpr std::uint32_t c_indexMask = (1u << c_indexBits) - 1;
+		static constexpr std::uint32_t c_maxIndex = c_indexMask; // all index bits set is reserved, as the null ID matches it
+
 	private:
 		friend CoreType detail::AccessECSID(EntityID);
 
 		static constexpr CoreType s_nullID{ static_cast<CoreType::value>(-1) };
 		CoreType m_entity{ s_nullID };
+		std::uint32_t m_generation{ 0 };
 
 	public:
-		bool IsValid() const { return m_entity != s_nullID; }
+		// Also false for handles to destroyed entities. Generations are 32 bit, so an index would need reusing 2^32 times before a stale handle passed.
+		bool IsValid() const { return m_entity != s_nullID && detail::IsCurrentGeneration(*this); }
 		bool IsNull() const { return m_entity == s_nullID; }
+
+		std::uint32_t GetIndex() const { return static_cast<std::uint32_t>(static_cast<CoreType::value>(m_entity)) & c_indexMask; }
+		std::uint32_t GetGeneration() const { return m_generation; }
 		bool operator<(EntityID const& _o) const
 		{
-			return m_entity < _o.m_entity;
+			return m_entity < _o.m_entity || (m_entity == _o.m_entity && m_generation < _o.m_generation);
 		}
 		bool operator==(EntityID const& _o) const
 		{
-			return m_entity == _o.m_entity;
+			return m_entity == _o.m_entity && m_generation == _o.m_generation;
 		}
 
 		EntityID() = default;
-		EntityID(CoreType _entity) : m_entity{ _entity } {}
+		// IDs from the ecs runtime are always of live entities, so they take the index's current generation.
+		EntityID(CoreType _entity)
+			: m_entity{ _entity }
+			, m_generation{ _entity != s_nullID ? detail::GetCurrentGeneration(GetIndex()) : 0 }
+		{}
+
+		static EntityID Make(std::uint32_t _index, std::uint32_t _generation)
+		{
+			EntityID entity;
+			entity.m_entity = CoreType{ static_cast<CoreType::value>(_index & c_indexMask) };
+			entity.m_generation = _generation;
+			return entity;
+		}
 
 #if DEBUG_TOOLS
 		CoreType::value GetDebugValue() const { return m_entity; }
@@ -61,7 +88,7 @@ namespace std
 	{
 		std::size_t operator()(Core::EntityID const& _k) const
 		{
-			return hash<ecs::detail::entity_type>()(Core::detail::AccessECSID(_k));
+			return hash<std::uint64_t>()((static_cast<std::uint64_t>(_k.GetGeneration()) << 32) | _k.GetIndex());
 		}
 	};
 }
\ No newline at end of file
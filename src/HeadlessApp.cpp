@@ -0,0 +1,33 @@
+#include "common.h"
+
+// Headless builds have no window, so sokol_app's implementation isn't compiled (it has no dummy backend).
+// These stand in for the parts of it used by the engine and by the sokol utility headers, as a window that never receives events.
+// sokol_glue isn't compiled either, as it needs every backend's getters. RenderManager.cpp fills in the context itself.
+
+#include <sokol_gfx.h>
+#include <sokol_app.h>
+
+static constexpr int c_headlessWidth = 960;
+static constexpr int c_headlessHeight = 720;
+
+extern "C"
+{
+	int sapp_width(void) { return c_headlessWidth; }
+	float sapp_widthf(void) { return static_cast<float>(c_headlessWidth); }
+	int sapp_height(void) { return c_headlessHeight; }
+	float sapp_heightf(void) { return static_cast<float>(c_headlessHeight); }
+	int sapp_color_format(void) { return SG_PIXELFORMAT_RGBA8; }
+	int sapp_depth_format(void) { return SG_PIXELFORMAT_DEPTH_STENCIL; }
+	int sapp_sample_count(void) { return 1; }
+	bool sapp_high_dpi(void) { return false; }
+	float sapp_dpi_scale(void) { return 1.0f; }
+	void sapp_show_keyboard(bool _show) {}
+	bool sapp_keyboard_shown(void) { return false; }
+	void sapp_lock_mouse(bool _lock) {}
+	bool sapp_mouse_locked(void) { return false; }
+	void sapp_set_mouse_cursor(sapp_mouse_cursor _cursor) {}
+	sapp_mouse_cursor sapp_get_mouse_cursor(void) { return SAPP_MOUSECURSOR_DEFAULT; }
+	void sapp_set_clipboard_string(char const* _str) {}
+	char const* sapp_get_clipboard_string(void) { return ""; }
+	void sapp_request_quit(void) {}
+}
\ No newline at end of file
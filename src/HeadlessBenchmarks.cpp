@@ -0,0 +1,611 @@
+#include "HeadlessBenchmarks.h"
+
+#include "managers/EntityManager.h"
+#include "components.h"
+#include "common/TransformBatch.h"
+#include "managers/ResourceManager.h"
+#include "managers/RenderTools/SpriteSceneData.h"
+#include "systems/Core/ResourceSystems.h"
+
+#include <sokol_time.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench
+{
+	// Returns false if one of the benchmark's checks failed.
+	using BenchFn = bool(*)();
+	struct Benchmark
+	{
+		std::string_view m_name;
+		BenchFn m_fn;
+		bool m_ownProcess{ false }; // leaves state behind that would skew another run, so "all" skips it
+	};
+
+	static void DestroyRange
+	(
+		Core::EntityRange _entities
+	)
+	{
+		for (uint32 i = 0; i < _entities.Count(); ++i)
+		{
+			Core::DestroyEntity(_entities[i]);
+		}
+		Core::ECS::CommitChanges();
+	}
+
+	// Plain component without an AddComponent specialisation, so CreateEntities can hand it to the ecs runtime for the whole range at once.
+	struct BenchValue
+	{
+		uint32 m_value{ 0 };
+	};
+
+	//--------------------------------------------------------------------------------
+	// Compares CreateEntities against CreateEntity + AddComponents for each entity, at Gin Rummy deck size and particle burst size. Both include the commit.
+	// Also checks that repeatedly recreating a range reuses the destroyed indices rather than growing the index space,
+	// and that bulk created sprites go through SpriteDesc's AddComponent, so that each one ends up with a Render::Sprite.
+	static bool EntityCreation()
+	{
+		constexpr uint32 c_counts[] = { 52, 10'000 };
+		constexpr uint32 c_rounds = 5;
+
+		std::cout << std::format("createentities: Transform3D + a plain component, best of {:d}\n", c_rounds);
+		std::cout << std::format("{:<12s}{:>16s}{:>16s}\n", "entities", "per entity ms", "range ms");
+		for (uint32 const count : c_counts)
+		{
+			dVec1 bestPerEntityMs{ std::numeric_limits<dVec1>::max() };
+			dVec1 bestRangeMs{ std::numeric_limits<dVec1>::max() };
+			for (uint32 roundI = 0; roundI < c_rounds; ++roundI)
+			{
+				std::vector<Core::EntityID> entities;
+				entities.reserve(count);
+
+				uint64 const perEntityTicks = stm_now();
+				for (uint32 entityI = 0; entityI < count; ++entityI)
+				{
+					Core::EntityID const entity = Core::CreateEntity();
+					Core::AddComponents(entity, Core::Transform3D{}, BenchValue{ entityI });
+					entities.emplace_back(entity);
+				}
+				Core::ECS::CommitChanges();
+				bestPerEntityMs = std::min(bestPerEntityMs, stm_ms(stm_since(perEntityTicks)));
+
+				for (Core::EntityID const entity : entities)
+				{
+					Core::DestroyEntity(entity);
+				}
+				Core::ECS::CommitChanges();
+
+				uint64 const rangeTicks = stm_now();
+				Core::EntityRange const range = Core::CreateEntities(count, Core::Transform3D{}, BenchValue{});
+				Core::ECS::CommitChanges();
+				bestRangeMs = std::min(bestRangeMs, stm_ms(stm_since(rangeTicks)));
+
+				DestroyRange(range);
+			}
+			std::cout << std::format("{:<12d}{:>16.3f}{:>16.3f}\n", count, bestPerEntityMs, bestRangeMs);
+		}
+
+		// Churn, as scene reloads do: the same count recreated every round should keep reusing the same indices.
+		constexpr uint32 c_churnCount = 10'000;
+		constexpr uint32 c_churnRounds = 50;
+		DestroyRange(Core::CreateEntities(c_churnCount, Core::Transform3D{}, BenchValue{}));
+		uint32 const usedIndicesBefore = Core::GetUsedEntityIndexCount();
+		uint64 const churnTicks = stm_now();
+		for (uint32 roundI = 0; roundI < c_churnRounds; ++roundI)
+		{
+			Core::EntityRange const range = Core::CreateEntities(c_churnCount, Core::Transform3D{}, BenchValue{});
+			Core::ECS::CommitChanges();
+			DestroyRange(range);
+		}
+		dVec1 const churnMs = stm_ms(stm_since(churnTicks)) / c_churnRounds;
+		uint32 const usedIndicesAfter = Core::GetUsedEntityIndexCount();
+		bool const churnPassed = usedIndicesAfter == usedIndicesBefore;
+		std::cout << std::format("churn: {:d} rounds of {:d}, {:.3f}ms per create + destroy\n", c_churnRounds, c_churnCount, churnMs);
+		std::cout << std::format("{:s}: {:d} entity indices used before, {:d} after\n", churnPassed ? "passed" : "FAILED", usedIndicesBefore, usedIndicesAfter);
+
+		constexpr uint32 c_numSprites = 64;
+		Core::EntityRange const sprites = Core::CreateEntities(c_numSprites, Core::Transform2D{}, Core::Render::SpriteDesc{ .m_spriteInit = std::string{ "assets/sprites/loading/loading.spr" }, .m_initTrans = {}, .m_initFlags = 0u });
+		Core::ECS::CommitChanges();
+
+		uint32 numWithSprite{ 0 };
+		for (uint32 i = 0; i < sprites.Count(); ++i)
+		{
+			numWithSprite += Core::GetComponent<Core::Render::Sprite>(sprites[i]) != nullptr ? 1 : 0;
+		}
+		DestroyRange(sprites);
+
+		bool const spritesPassed = numWithSprite == c_numSprites;
+		std::cout << std::format("{:s}: {:d}/{:d} bulk created sprites have a Render::Sprite\n", spritesPassed ? "passed" : "FAILED", numWithSprite, c_numSprites);
+		return churnPassed && spritesPassed;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Builds a 100k entity scene of parented transforms (1000 roots, each with 9 children with 10 children each), then times the scene transition that tears it down.
+	static bool Teardown()
+	{
+		constexpr uint32 c_numRoots = 1000;
+		constexpr uint32 c_childrenPerRoot = 9;
+		constexpr uint32 c_grandchildrenPerChild = 10;
+		constexpr uint32 c_numEntities = c_numRoots * (1 + c_childrenPerRoot * (1 + c_grandchildrenPerChild));
+
+		uint64 const createTicks = stm_now();
+		Core::EntityRange const roots = Core::CreateEntities(c_numRoots, Core::Transform3D{});
+		for (uint32 rootI = 0; rootI < roots.Count(); ++rootI)
+		{
+			Core::EntityRange const children = Core::CreateEntities(c_childrenPerRoot, Core::Transform3D{ roots[rootI] });
+			for (uint32 childI = 0; childI < children.Count(); ++childI)
+			{
+				Core::CreateEntities(c_grandchildrenPerChild, Core::Transform3D{ children[childI] });
+			}
+		}
+		Core::ECS::CommitChanges();
+		dVec1 const createMs = stm_ms(stm_since(createTicks));
+
+		uint64 const destroyTicks = stm_now();
+		Core::Scene::NextScene(nullptr);
+		dVec1 const destroyMs = stm_ms(stm_since(destroyTicks));
+
+		// the ecs runtime only drops the components on its next commit
+		uint64 const commitTicks = stm_now();
+		Core::ECS::CommitChanges();
+		dVec1 const commitMs = stm_ms(stm_since(commitTicks));
+
+		std::cout << std::format("teardown: {:d} entities in a 3 level hierarchy\n", c_numEntities);
+		std::cout << std::format("{:<28s}{:10.3f} ms\n", "create + commit", createMs);
+		std::cout << std::format("{:<28s}{:10.3f} ms\n", "scene transition", destroyMs);
+		std::cout << std::format("{:<28s}{:10.3f} ms\n", "commit removals", commitMs);
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Times _fn over _rounds runs and returns the fastest, in ms.
+	template<typename T_Fn>
+	static dVec1 BestOf
+	(
+		uint32 _rounds,
+		T_Fn const& _fn
+	)
+	{
+		dVec1 bestMs{ std::numeric_limits<dVec1>::max() };
+		for (uint32 roundI = 0; roundI < _rounds; ++roundI)
+		{
+			uint64 const ticks = stm_now();
+			_fn();
+			bestMs = std::min(bestMs, stm_ms(stm_since(ticks)));
+		}
+		return bestMs;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Compares the TransformBatch kernels against the scalar glm path they replace, on random scaled and rotated transforms.
+	// Also checks that both give the same results.
+	static bool TransformBatchKernels()
+	{
+		constexpr usize c_count = 10'000;
+		constexpr uint32 c_rounds = 50;
+		constexpr Vec1 c_tolerance = 1e-4f;
+
+		std::mt19937 rng{ 1234 };
+		std::uniform_real_distribution<Vec1> angle{ -3.14159f, 3.14159f };
+		std::uniform_real_distribution<Vec1> scale{ 0.5f, 2.0f };
+		std::uniform_real_distribution<Vec1> position{ -100.0f, 100.0f };
+		auto const randomTrans = [&]()
+		{
+			Mat3 basis{ glm::eulerAngleYXZ(angle(rng), angle(rng), angle(rng)) };
+			basis[0] *= scale(rng);
+			basis[1] *= scale(rng);
+			basis[2] *= scale(rng);
+			return Trans{ basis, Vec3(position(rng), position(rng), position(rng)) };
+		};
+
+		std::vector<Trans> parents(c_count);
+		std::vector<Trans> locals(c_count);
+		std::generate(parents.begin(), parents.end(), randomTrans);
+		std::generate(locals.begin(), locals.end(), randomTrans);
+		Mat4 const view = glm::lookAt(Vec3(10.0f, 20.0f, 30.0f), Vec3(0.0f), Vec3(0.0f, 1.0f, 0.0f));
+
+		std::vector<Trans> scalarComposed(c_count);
+		std::vector<Trans> batchComposed(c_count);
+		dVec1 const scalarComposeMs = BestOf(c_rounds, [&]()
+		{
+			for (usize i = 0; i < c_count; ++i)
+			{
+				scalarComposed[i] = parents[i] * locals[i];
+			}
+		});
+		dVec1 const batchComposeMs = BestOf(c_rounds, [&]()
+		{
+			TransformBatch::Compose(parents.data(), locals.data(), c_count, batchComposed.data());
+		});
+
+		// render matrices, then view * model and normal matrices, as Render3D does with them
+		std::vector<Mat4> models(c_count);
+		std::vector<Mat4> scalarViewModels(c_count);
+		std::vector<Mat4> scalarNormals(c_count);
+		std::vector<Mat4> batchViewModels(c_count);
+		std::vector<Mat4> batchNormals(c_count);
+		dVec1 const scalarMatricesMs = BestOf(c_rounds, [&]()
+		{
+			for (usize i = 0; i < c_count; ++i)
+			{
+				Mat4 const model = batchComposed[i].GetRenderMatrix();
+				scalarViewModels[i] = view * model;
+				scalarNormals[i] = Mat4(glm::transpose(glm::inverse(Mat3(model))));
+			}
+		});
+		dVec1 const batchMatricesMs = BestOf(c_rounds, [&]()
+		{
+			for (usize i = 0; i < c_count; ++i)
+			{
+				models[i] = batchComposed[i].GetRenderMatrix();
+			}
+			TransformBatch::MultiplyAffine(view, models.data(), c_count, batchViewModels.data());
+			TransformBatch::GetNormalMatrices(models.data(), c_count, batchNormals.data());
+		});
+
+		// relative to the size of the values, as the composed origins get large
+		Vec1 maxError{ 0.0f };
+		auto const compare = [&maxError](Vec1 _a, Vec1 _b)
+		{
+			maxError = std::max(maxError, std::abs(_a - _b) / std::max(1.0f, std::abs(_a)));
+		};
+		for (usize i = 0; i < c_count; ++i)
+		{
+			for (int32 col = 0; col < 3; ++col)
+			{
+				for (int32 row = 0; row < 3; ++row)
+				{
+					compare(scalarComposed[i].m_basis[col][row], batchComposed[i].m_basis[col][row]);
+				}
+				compare(scalarComposed[i].m_origin[col], batchComposed[i].m_origin[col]);
+			}
+			for (int32 col = 0; col < 4; ++col)
+			{
+				for (int32 row = 0; row < 4; ++row)
+				{
+					compare(scalarViewModels[i][col][row], batchViewModels[i][col][row]);
+					compare(scalarNormals[i][col][row], batchNormals[i][col][row]);
+				}
+			}
+		}
+
+		std::cout << std::format("transformbatch: {:d} transforms, best of {:d}\n", c_count, c_rounds);
+		std::cout << std::format("{:<28s}{:>14s}{:>14s}\n", "", "scalar ms", "batch ms");
+		std::cout << std::format("{:<28s}{:>14.3f}{:>14.3f}\n", "compose", scalarComposeMs, batchComposeMs);
+		std::cout << std::format("{:<28s}{:>14.3f}{:>14.3f}\n", "view * model + normal", scalarMatricesMs, batchMatricesMs);
+
+		bool const passed = maxError < c_tolerance;
+		std::cout << std::format("{:s}: largest relative difference {:g}\n", passed ? "passed" : "FAILED", maxError);
+		return passed;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Times SpriteSceneData's incremental Reorder against FullReorder, with a number of sprites changing z each frame. Used to pick c_fullReorderThreshold and c_fullReorderSceneDivisor.
+	// Uses its own scene of made up alpha sprites (z only affects the order of those) spread over a few textures.
+	// Nudged sprites move a little, like cards being lifted; random ones jump anywhere, the worst case for Reorder.
+	static bool SpriteReorder()
+	{
+		constexpr usize c_sceneSizes[] = { 256, 4096 };
+		constexpr usize c_zChangeCounts[] = { 1, 16, 64, 128, 256, 512, 1024, 2048 };
+		constexpr uint32 c_numTextures = 8;
+		constexpr uint32 c_numFrames = 200;
+
+		auto const runFrames = [](usize _sceneSize, usize _zChanges, bool _nudge, usize _threshold)
+		{
+			Core::Render::SpriteSceneData scene;
+			scene.SetFullReorderThreshold(_threshold);
+
+			std::mt19937 rng{ 1234 };
+			std::uniform_real_distribution<Vec1> randomZ{ -1.0f, 1.0f };
+			std::uniform_real_distribution<Vec1> nudgeZ{ -0.01f, 0.01f };
+			std::uniform_int_distribution<usize> pickSprite{ 0, _sceneSize - 1 };
+
+			std::vector<Core::Render::SpriteSceneID> sprites;
+			std::vector<Trans2D> transforms;
+			sprites.reserve(_sceneSize);
+			transforms.reserve(_sceneSize);
+			for (usize spriteI = 0; spriteI < _sceneSize; ++spriteI)
+			{
+				Core::Resource::SpriteData spriteData;
+				spriteData.m_texture = Core::Resource::TextureID::FromIndex(1 + spriteI % c_numTextures);
+				spriteData.m_useAlpha = true;
+
+				Trans2D trans;
+				trans.m_z = randomZ(rng);
+				sprites.emplace_back(scene.Add(Core::Resource::SpriteID::FromIndex(spriteI), spriteData, trans, 0u));
+				transforms.emplace_back(trans);
+			}
+
+			auto const noStart = [](std::vector<Core::Render::SpriteBufferData> const&, bool) {};
+			auto const noDraw = [](Core::Render::SpriteSceneData::DrawCall const&) {};
+			scene.RunRender(noStart, noDraw);
+
+			uint64 const ticks = stm_now();
+			for (uint32 frameI = 0; frameI < c_numFrames; ++frameI)
+			{
+				for (usize changeI = 0; changeI < _zChanges; ++changeI)
+				{
+					usize const spriteI = pickSprite(rng);
+					Trans2D& trans = transforms[spriteI];
+					trans.m_z = _nudge ? std::clamp(trans.m_z + nudgeZ(rng), -1.0f, 1.0f) : randomZ(rng);
+					scene.Update(sprites[spriteI], trans, 0u);
+				}
+				scene.RunRender(noStart, noDraw);
+			}
+			return stm_ms(stm_since(ticks)) / c_numFrames;
+		};
+
+		std::cout << std::format("spritereorder: ms per frame over {:d} frames\n", c_numFrames);
+		for (bool const nudge : { true, false })
+		{
+			for (usize const sceneSize : c_sceneSizes)
+			{
+				std::cout << std::format("{:d} sprites, {:s} z, default threshold {:d}\n", sceneSize, nudge ? "nudged" : "random", std::max(Core::Render::c_fullReorderThreshold, sceneSize / Core::Render::c_fullReorderSceneDivisor));
+				std::cout << std::format("{:<12s}{:>14s}{:>14s}\n", "z changes", "reorder", "full");
+				for (usize const zChanges : c_zChangeCounts)
+				{
+					dVec1 const reorderMs = runFrames(sceneSize, zChanges, nudge, ~usize{ 0 });
+					dVec1 const fullMs = runFrames(sceneSize, zChanges, nudge, 0);
+					std::cout << std::format("{:<12d}{:>14.4f}{:>14.4f}\n", zChanges, reorderMs, fullMs);
+				}
+			}
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Times repeat loads of already loaded resources through the real API, which only have to find the path in the resource manager's path -> ID maps.
+	// The manifest is generated: small sprite files in a temp folder that all share one texture, so only the first load of each touches the disk.
+	static bool PathLookup()
+	{
+		constexpr usize c_manifestSize = 5'000;
+		constexpr uint32 c_rounds = 5;
+		static constexpr char const* c_sourceTexture = "assets/sprites/loading/loading.png";
+
+		std::filesystem::path const folder = std::filesystem::temp_directory_path() / "drift_pathlookup";
+		std::error_code error;
+		std::filesystem::create_directories(folder, error);
+		std::filesystem::copy_file(c_sourceTexture, folder / "shared.png", std::filesystem::copy_options::overwrite_existing, error);
+		if (error)
+		{
+			std::cout << std::format("pathlookup: could not copy {:s}, sprites will load without a texture\n", c_sourceTexture);
+		}
+
+		// shared prefixes, like a real asset tree, so the string compares don't all fail on the first character
+		std::vector<std::string> paths;
+		paths.reserve(c_manifestSize);
+		for (usize pathI = 0; pathI < c_manifestSize; ++pathI)
+		{
+			std::string const path = (folder / std::format("set{:02d}_frame{:05d}.spr", pathI % 50, pathI)).generic_string();
+			std::ofstream spriteFile{ path };
+			spriteFile << "shared.png\n32 32\n0 0\n";
+			if (!spriteFile)
+			{
+				std::cout << std::format("FAILED: could not write {:s}\n", path);
+				return false;
+			}
+			paths.push_back(path);
+		}
+		std::string const texturePath = (folder / "shared.png").generic_string();
+
+		// first loads read every sprite file, and are only reported for scale
+		std::vector<Core::Resource::SpriteID> ids(c_manifestSize);
+		usize failed{ 0 };
+		uint64 const firstLoadTicks = stm_now();
+		for (usize pathI = 0; pathI < c_manifestSize; ++pathI)
+		{
+			failed += Core::Resource::LoadSprite(paths[pathI], ids[pathI]) ? 0 : 1;
+		}
+		dVec1 const firstLoadMs = stm_ms(stm_since(firstLoadTicks));
+
+		std::vector<usize> lookupOrder(c_manifestSize);
+		for (usize pathI = 0; pathI < c_manifestSize; ++pathI)
+		{
+			lookupOrder[pathI] = pathI;
+		}
+		std::shuffle(lookupOrder.begin(), lookupOrder.end(), std::mt19937{ 1234 });
+
+		usize mismatches{ 0 };
+		dVec1 const spriteHitMs = BestOf(c_rounds, [&]()
+		{
+			for (usize const pathI : lookupOrder)
+			{
+				Core::Resource::SpriteID id;
+				mismatches += Core::Resource::LoadSprite(paths[pathI], id) && id == ids[pathI] ? 0 : 1;
+			}
+		});
+
+		Core::Resource::TextureID textureID;
+		bool const textureLoaded = Core::Resource::Load2DTexture(texturePath, textureID, Core::Resource::TextureData::Type::General2D);
+		dVec1 textureHitMs{ 0.0 };
+		if (textureLoaded)
+		{
+			textureHitMs = BestOf(c_rounds, [&]()
+			{
+				for (usize hitI = 0; hitI < c_manifestSize; ++hitI)
+				{
+					Core::Resource::TextureID id;
+					mismatches += Core::Resource::Load2DTexture(texturePath, id, Core::Resource::TextureData::Type::General2D) && id == textureID ? 0 : 1;
+				}
+			});
+		}
+
+		std::cout << std::format("pathlookup: {:d} sprite manifest in {:s}, best of {:d}\n", c_manifestSize, folder.generic_string(), c_rounds);
+		std::cout << std::format("{:<24s}{:>12.3f} ms\n", "first LoadSprite", firstLoadMs);
+		std::cout << std::format("{:<24s}{:>12.3f} ms\n", "repeat LoadSprite", spriteHitMs);
+		if (textureLoaded)
+		{
+			std::cout << std::format("{:<24s}{:>12.3f} ms\n", "repeat Load2DTexture", textureHitMs);
+		}
+
+		bool const passed = failed == 0 && mismatches == 0;
+		std::cout << std::format("{:s}: {:d} failed loads, {:d} repeat loads returning a different ID\n", passed ? "passed" : "FAILED", failed, mismatches);
+		return passed;
+	}
+
+	//--------------------------------------------------------------------------------
+	// Loaded resources can't be unloaded, so each preload benchmark needs a fresh process. Compare the two with
+	// drift_headless --bench preloadserial and drift_headless --bench preloadasync.
+	static constexpr char const* c_preloadResFile = "assets/preload.res";
+
+	// The old preload path: one synchronous load per frame on the main thread.
+	static bool PreloadSerial()
+	{
+		std::vector<Core::Resource::Preload::FileToLoad> files;
+		Core::Resource::FillFilesToLoad(c_preloadResFile, files);
+
+		usize failed{ 0 };
+		dVec1 longestMs{ 0.0 };
+		uint64 const ticks = stm_now();
+		for (Core::Resource::Preload::FileToLoad const& file : files)
+		{
+			uint64 const frameTicks = stm_now();
+			bool success{ false };
+			switch (file.m_fileType)
+			{
+				using enum Core::Resource::FileType;
+
+			case Model:
+			{
+				Core::Resource::ModelID modelID;
+				success = Core::Resource::LoadModel(file.m_filePath, modelID);
+				break;
+			}
+			case Texture2D:
+			{
+				Core::Resource::TextureID textureID;
+				success = Core::Resource::Load2DTexture(file.m_filePath, textureID, Core::Resource::TextureData::Type::General2D);
+				break;
+			}
+			case Cubemap:
+			{
+				Core::Resource::TextureID cubemapID;
+				success = Core::Resource::LoadCubemap(file.m_filePath, cubemapID);
+				break;
+			}
+			case Sprite:
+			{
+				Core::Resource::SpriteID spriteID;
+				success = Core::Resource::LoadSprite(file.m_filePath, spriteID);
+				break;
+			}
+			case SFX:
+			{
+				Core::Resource::SoundEffectID sfxID;
+				success = Core::Resource::LoadSoundEffect(file.m_filePath, sfxID);
+				break;
+			}
+			case BGM:
+			{
+				Core::Resource::MusicID bgmID;
+				success = Core::Resource::LoadMusic(file.m_filePath, bgmID);
+				break;
+			}
+			}
+			failed += success ? 0 : 1;
+			longestMs = std::max(longestMs, stm_ms(stm_since(frameTicks)));
+		}
+		Core::Resource::PackSpriteAtlases();
+		dVec1 const totalMs = stm_ms(stm_since(ticks));
+
+		std::cout << std::format("preloadserial: {:s}, one file per frame on the main thread\n", c_preloadResFile);
+		std::cout << std::format("{:d} files ({:d} failed) in {:.3f}ms over {:d} frames, longest frame {:.3f}ms\n", files.size(), failed, totalMs, files.size(), longestMs);
+		std::cout << std::format("{:.1f}MB of textures\n", static_cast<dVec1>(Core::Resource::GetTotalTextureBytes()) / (1024.0 * 1024.0));
+		return failed == 0;
+	}
+
+	// The current preload path: everything queued for the loading threads, finished within the per frame budget.
+	// Frames only count the slices that finished something, as the real loop would render between them.
+	static bool PreloadAsync()
+	{
+		std::vector<Core::Resource::Preload::FileToLoad> files;
+		Core::Resource::FillFilesToLoad(c_preloadResFile, files);
+
+		usize finished{ 0 };
+		usize frames{ 0 };
+		dVec1 longestMs{ 0.0 };
+		uint64 const ticks = stm_now();
+		for (Core::Resource::Preload::FileToLoad const& file : files)
+		{
+			Core::Resource::QueueAsyncLoad(file.m_filePath, file.m_fileType);
+		}
+		while (Core::Resource::HasAsyncLoadsInFlight())
+		{
+			uint64 const frameTicks = stm_now();
+			usize const finishedThisFrame = Core::Resource::FinishAsyncLoads(Core::Resource::c_preloadFinishBudgetMs);
+			if (finishedThisFrame > 0)
+			{
+				finished += finishedThisFrame;
+				++frames;
+				longestMs = std::max(longestMs, stm_ms(stm_since(frameTicks)));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		Core::Resource::PackSpriteAtlases();
+		dVec1 const totalMs = stm_ms(stm_since(ticks));
+
+		std::cout << std::format("preloadasync: {:s}, {:.1f}ms main thread budget per frame\n", c_preloadResFile, Core::Resource::c_preloadFinishBudgetMs);
+		std::cout << std::format("{:d} files ({:d} finished) in {:.3f}ms over {:d} frames, longest frame {:.3f}ms\n", files.size(), finished, totalMs, frames, longestMs);
+		std::cout << std::format("{:.1f}MB of textures\n", static_cast<dVec1>(Core::Resource::GetTotalTextureBytes()) / (1024.0 * 1024.0));
+		return finished == files.size();
+	}
+
+	//--------------------------------------------------------------------------------
+	// Destructive ones (like teardown) go last, so "all" doesn't measure the others on an emptied scene.
+	static constexpr Benchmark c_benchmarks[] = {
+		{ "createentities", &EntityCreation },
+		{ "transformbatch", &TransformBatchKernels },
+		{ "spritereorder", &SpriteReorder },
+		{ "pathlookup", &PathLookup },
+		{ "preloadserial", &PreloadSerial, true },
+		{ "preloadasync", &PreloadAsync, true },
+		{ "teardown", &Teardown },
+	};
+
+	Result Run
+	(
+		std::string_view _name
+	)
+	{
+		bool ranAny{ false };
+		bool passed{ true };
+		for (Benchmark const& benchmark : c_benchmarks)
+		{
+			if ((_name == "all" && !benchmark.m_ownProcess) || _name == benchmark.m_name)
+			{
+				passed &= benchmark.m_fn();
+				std::cout << '\n';
+				ranAny = true;
+			}
+		}
+
+		if (!ranAny)
+		{
+			return Result::UnknownName;
+		}
+		return passed ? Result::Passed : Result::ChecksFailed;
+	}
+
+	std::string GetNames()
+	{
+		std::string names{ "all" };
+		for (Benchmark const& benchmark : c_benchmarks)
+		{
+			names += std::format("|{:s}", benchmark.m_name);
+		}
+		return names;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common.h"
+
+#include <string>
+#include <string_view>
+
+// Microbenchmarks for the headless build, run by drift_headless --bench <name> in place of the frame loop.
+// They run after Initialise, so the engine is fully set up, but no frames have been run and no scene has been loaded.
+namespace Bench
+{
+	enum class Result
+	{
+		Passed,
+		ChecksFailed, // some benchmarks also check the results of what they time
+		UnknownName,
+	};
+
+	// Runs the named benchmark, or every one for "all", printing results to stdout.
+	Result Run(std::string_view _name);
+
+	// For usage messages, e.g. "all|teardown".
+	std::string GetNames();
+}
\ No newline at end of file
@@ -9,6 +9,7 @@ inline constexpr bool AnyThread = false;
 X( FRAME_START, AnyThread ) \
 	X( FILE_LOADING, MainThread ) /* main thread only */ \
 	X( UI_UPDATE, AnyThread ) /* usually doesn't want to act the same time as GAME, but does want to be before sending off text and render requests and after a game update. */ \
+	X( WORLD_TRANSFORMS, AnyThread ) /* caches world transforms for the render queue */ \
 	\
 	X( GL_START, MainThread ) /* GL drawing can happen anywhere between here and GL_END */ \
 	/* Render section - can NOT be parallel. Use MT_Only global component as non-const ref to force serial */ \
@@ -27,6 +28,7 @@ X( FRAME_START, AnyThread ) \
 		X( RENDER, MainThread ) /* = GAME, */ /* todo can't do this, must run on main thread... */ /* run bulk of the render code during the GAME section. */ \
 		X( RENDER_PASS_END, MainThread ) \
 		\
+		X( PHYSICS_WORLD_TRANSFORMS, AnyThread ) /* re-caches anything moved during GAME */ \
 		X( PHYSICS_TRANSFORMS_IN, AnyThread ) \
 		X( PHYSICS_STEP, AnyThread ) \
 		X( PHYSICS_TRANSFORMS_OUT, AnyThread ) \
@@ -49,6 +51,12 @@ inline constexpr bool c_mtOnlySysOrdering[ SystemOrdering::COUNT ] = {
 };
 #undef X
 
+#define X( NAME, THREADING ) #NAME ,
+inline constexpr char const* c_sysOrderingNames[ SystemOrdering::COUNT ] = {
+	SYSTEM_ORDERING_LIST
+};
+#undef X
+
 #undef SYSTEM_ORDERING_LIST
 
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ constexpr void SafeDelete(T*& _obj)
 // component helpers
 #define use_initialiser struct _initialiser_only {}
 #define not_a_component struct _not_a_component {}
+#define custom_add_component struct _custom_add_component {} // has an AddComponent specialisation, which AddComponentToRange must go through
 
 // GLSL header cross-usage
 #define GLSL_CONSTANT inline constexpr
@@ -83,6 +83,12 @@ public:
 	{
 		return { m_mutex, m_value };
 	}
+
+	// Skips the lock. Only for hot paths that can't run at the same time as any writer, which the caller should explain.
+	T_Value const& ReadUnlocked() const
+	{
+		return m_value;
+	}
 };
 
 template< typename T >
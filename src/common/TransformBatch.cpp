@@ -0,0 +1,300 @@
+#include "TransformBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if __AVX__ || __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace TransformBatch
+{
+#if __SSE2__
+	// One column of _pre * M, given the column of M. Columns 0-2 of an affine matrix have w = 0, column 3 has w = 1.
+	static inline __m128 MultiplyColumn(__m128 const (&_pre)[4], __m128 _col, bool _isOrigin)
+	{
+		__m128 result = _mm_mul_ps(_pre[0], _mm_shuffle_ps(_col, _col, _MM_SHUFFLE(0, 0, 0, 0)));
+		result = _mm_add_ps(result, _mm_mul_ps(_pre[1], _mm_shuffle_ps(_col, _col, _MM_SHUFFLE(1, 1, 1, 1))));
+		result = _mm_add_ps(result, _mm_mul_ps(_pre[2], _mm_shuffle_ps(_col, _col, _MM_SHUFFLE(2, 2, 2, 2))));
+		return _isOrigin ? _mm_add_ps(result, _pre[3]) : result;
+	}
+
+	static inline __m128 Cross(__m128 _a, __m128 _b)
+	{
+		// a.yzx * b.zxy - a.zxy * b.yzx, w stays 0 as long as the inputs have w = 0
+		__m128 const aYZX = _mm_shuffle_ps(_a, _a, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 const bYZX = _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 const crossZXY = _mm_sub_ps(_mm_mul_ps(_a, bYZX), _mm_mul_ps(aYZX, _b));
+		return _mm_shuffle_ps(crossZXY, crossZXY, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+#endif
+
+#if __AVX__
+	// As MultiplyColumn, but for the same column of two matrices at once, one per 128-bit lane.
+	static inline __m256 MultiplyColumn2(__m256 const (&_pre)[4], __m256 _cols, bool _isOrigin)
+	{
+		__m256 result = _mm256_mul_ps(_pre[0], _mm256_permute_ps(_cols, _MM_SHUFFLE(0, 0, 0, 0)));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_pre[1], _mm256_permute_ps(_cols, _MM_SHUFFLE(1, 1, 1, 1))));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_pre[2], _mm256_permute_ps(_cols, _MM_SHUFFLE(2, 2, 2, 2))));
+		return _isOrigin ? _mm256_add_ps(result, _pre[3]) : result;
+	}
+#endif
+
+	void Compose
+	(
+		Trans const* _lhs,
+		Trans const* _rhs,
+		usize _count,
+		Trans* o_out
+	)
+	{
+#if __SSE2__
+		// Trans is 12 packed floats, 3 basis columns then the origin. Loads and stores are 4 wide, so they overlap by a float rather than touch the next transform.
+		static_assert(sizeof(Trans) == sizeof(float) * 12);
+
+		for (usize i = 0; i < _count; ++i)
+		{
+			float const* const lhs = &_lhs[i].m_basis[0][0];
+			float const* const rhs = &_rhs[i].m_basis[0][0];
+
+			// columns have junk in w, which only ever ends up in the w of the results
+			__m128 lhsRows[4]{ _mm_loadu_ps(lhs + 0), _mm_loadu_ps(lhs + 3), _mm_loadu_ps(lhs + 6), _mm_setzero_ps() };
+			__m128 const lhsCols[4]{ lhsRows[0], lhsRows[1], lhsRows[2], _mm_setzero_ps() };
+			__m128 const lhsOriginLoad = _mm_loadu_ps(lhs + 8);
+			__m128 const lhsOrigin = _mm_shuffle_ps(lhsOriginLoad, lhsOriginLoad, _MM_SHUFFLE(3, 3, 2, 1));
+			__m128 const rhsOriginLoad = _mm_loadu_ps(rhs + 8);
+			__m128 const rhsOrigin = _mm_shuffle_ps(rhsOriginLoad, rhsOriginLoad, _MM_SHUFFLE(3, 3, 2, 1));
+
+			// basis = lhs basis * rhs basis
+			__m128 const col0 = MultiplyColumn(lhsCols, _mm_loadu_ps(rhs + 0), false);
+			__m128 const col1 = MultiplyColumn(lhsCols, _mm_loadu_ps(rhs + 3), false);
+			__m128 const col2 = MultiplyColumn(lhsCols, _mm_loadu_ps(rhs + 6), false);
+
+			// origin = rhs origin * lhs basis + lhs origin, i.e. the rhs origin goes through the transpose of the lhs basis
+			_MM_TRANSPOSE4_PS(lhsRows[0], lhsRows[1], lhsRows[2], lhsRows[3]);
+			__m128 const origin = _mm_add_ps(MultiplyColumn(lhsRows, rhsOrigin, false), lhsOrigin);
+
+			// stored in order, so each store's spare float is overwritten by the next. The last one is (col2.z, origin.xyz).
+			float* const out = &o_out[i].m_basis[0][0];
+			__m128 const col2zOriginX = _mm_shuffle_ps(col2, origin, _MM_SHUFFLE(0, 0, 2, 2));
+			_mm_storeu_ps(out + 0, col0);
+			_mm_storeu_ps(out + 3, col1);
+			_mm_storeu_ps(out + 6, col2);
+			_mm_storeu_ps(out + 8, _mm_shuffle_ps(col2zOriginX, origin, _MM_SHUFFLE(2, 1, 2, 0)));
+		}
+#else
+		for (usize i = 0; i < _count; ++i)
+		{
+			o_out[i] = _lhs[i] * _rhs[i];
+		}
+#endif
+	}
+
+	void MultiplyAffine
+	(
+		Mat4 const& _pre,
+		Mat4 const* _affine,
+		usize _count,
+		Mat4* o_out
+	)
+	{
+		kaAssert(_affine != o_out, "batch matrix multiply can't be done in place");
+
+		usize i = 0;
+
+#if __SSE2__
+		__m128 const pre[4]{ _mm_loadu_ps(&_pre[0][0]), _mm_loadu_ps(&_pre[1][0]), _mm_loadu_ps(&_pre[2][0]), _mm_loadu_ps(&_pre[3][0]) };
+
+#if __AVX__
+		__m256 const pre2[4]{ _mm256_set_m128(pre[0], pre[0]), _mm256_set_m128(pre[1], pre[1]), _mm256_set_m128(pre[2], pre[2]), _mm256_set_m128(pre[3], pre[3]) };
+
+		for (; i + 2 <= _count; i += 2)
+		{
+			float const* const inA = &_affine[i][0][0];
+			float const* const inB = &_affine[i + 1][0][0];
+			float* const outA = &o_out[i][0][0];
+			float* const outB = &o_out[i + 1][0][0];
+
+			for (usize col = 0; col < 4; ++col)
+			{
+				__m256 const cols = _mm256_set_m128(_mm_loadu_ps(inB + col * 4), _mm_loadu_ps(inA + col * 4));
+				__m256 const result = MultiplyColumn2(pre2, cols, col == 3);
+				_mm_storeu_ps(outA + col * 4, _mm256_castps256_ps128(result));
+				_mm_storeu_ps(outB + col * 4, _mm256_extractf128_ps(result, 1));
+			}
+		}
+#endif
+
+		for (; i < _count; ++i)
+		{
+			float const* const in = &_affine[i][0][0];
+			float* const out = &o_out[i][0][0];
+
+			for (usize col = 0; col < 4; ++col)
+			{
+				_mm_storeu_ps(out + col * 4, MultiplyColumn(pre, _mm_loadu_ps(in + col * 4), col == 3));
+			}
+		}
+#else
+		for (; i < _count; ++i)
+		{
+			o_out[i] = _pre * _affine[i];
+		}
+#endif
+	}
+
+	void GetNormalMatrices
+	(
+		Mat4 const* _matrices,
+		usize _count,
+		Mat4* o_out
+	)
+	{
+		for (usize i = 0; i < _count; ++i)
+		{
+#if __SSE2__
+			// inverse(M) has rows (b x c, c x a, a x b) / det for M with columns a, b, c, so its transpose has them as columns.
+			__m128 const wMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+			__m128 const a = _mm_and_ps(_mm_loadu_ps(&_matrices[i][0][0]), wMask);
+			__m128 const b = _mm_and_ps(_mm_loadu_ps(&_matrices[i][1][0]), wMask);
+			__m128 const c = _mm_and_ps(_mm_loadu_ps(&_matrices[i][2][0]), wMask);
+
+			__m128 const bc = Cross(b, c);
+			__m128 const ca = Cross(c, a);
+			__m128 const ab = Cross(a, b);
+
+			alignas(16) float detParts[4];
+			_mm_store_ps(detParts, _mm_mul_ps(a, bc));
+			float const det = detParts[0] + detParts[1] + detParts[2];
+			if (std::abs(det) < std::numeric_limits<float>::min())
+			{
+				o_out[i] = Mat4(1.0f);
+				continue;
+			}
+			__m128 const invDet = _mm_set1_ps(1.0f / det);
+
+			float* const out = &o_out[i][0][0];
+			_mm_storeu_ps(out + 0, _mm_mul_ps(bc, invDet));
+			_mm_storeu_ps(out + 4, _mm_mul_ps(ca, invDet));
+			_mm_storeu_ps(out + 8, _mm_mul_ps(ab, invDet));
+			_mm_storeu_ps(out + 12, _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+#else
+			Mat3 const basis{ _matrices[i] };
+			o_out[i] = std::abs(glm::determinant(basis)) < std::numeric_limits<float>::min() ? Mat4(1.0f) : Mat4(glm::transpose(glm::inverse(basis)));
+#endif
+		}
+	}
+
+	void TransformSpheres
+	(
+		Mat4 const* _affine,
+		Vec4 const* _spheres,
+		usize _count,
+		Vec4* o_out
+	)
+	{
+		for (usize i = 0; i < _count; ++i)
+		{
+#if __SSE2__
+			float const* const in = &_affine[i][0][0];
+			__m128 const cols[4]{ _mm_loadu_ps(in + 0), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), _mm_loadu_ps(in + 12) };
+			_mm_storeu_ps(&o_out[i][0], MultiplyColumn(cols, _mm_loadu_ps(&_spheres[i][0]), true));
+
+			// squared length of each basis column, summed across the transpose
+			__m128 x = _mm_mul_ps(cols[0], cols[0]);
+			__m128 y = _mm_mul_ps(cols[1], cols[1]);
+			__m128 z = _mm_mul_ps(cols[2], cols[2]);
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			alignas(16) float scalesSq[4];
+			_mm_store_ps(scalesSq, _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w)));
+			float const maxScaleSq = std::max(std::max(scalesSq[0], scalesSq[1]), scalesSq[2]);
+#else
+			o_out[i] = _affine[i] * Vec4(Vec3(_spheres[i]), 1.0f);
+			float const maxScaleSq = std::max(std::max(glm::dot(_affine[i][0], _affine[i][0]), glm::dot(_affine[i][1], _affine[i][1])), glm::dot(_affine[i][2], _affine[i][2]));
+#endif
+			o_out[i].w = _spheres[i].w * std::sqrt(maxScaleSq);
+		}
+	}
+
+	std::array<Vec4, 6> GetFrustumPlanes
+	(
+		Mat4 const& _clip
+	)
+	{
+		Mat4 const rows = glm::transpose(_clip);
+		std::array<Vec4, 6> planes{
+			rows[3] + rows[0],
+			rows[3] - rows[0],
+			rows[3] + rows[1],
+			rows[3] - rows[1],
+			rows[3] + rows[2],
+			rows[3] - rows[2],
+		};
+
+		for (Vec4& plane : planes)
+		{
+			plane /= glm::length(Vec3(plane));
+		}
+		return planes;
+	}
+
+	void CullSpheres
+	(
+		std::array<Vec4, 6> const& _planes,
+		Vec4 const* _spheres,
+		usize _count,
+		uint8* o_visible
+	)
+	{
+		// Planes are laid out by component, so each sphere is tested against several planes with one multiply-add per component.
+		// The planes are padded out with (0, 0, 0, 1), which everything is inside.
+#if __AVX__
+		__m256 const planeX = _mm256_setr_ps(_planes[0].x, _planes[1].x, _planes[2].x, _planes[3].x, _planes[4].x, _planes[5].x, 0.0f, 0.0f);
+		__m256 const planeY = _mm256_setr_ps(_planes[0].y, _planes[1].y, _planes[2].y, _planes[3].y, _planes[4].y, _planes[5].y, 0.0f, 0.0f);
+		__m256 const planeZ = _mm256_setr_ps(_planes[0].z, _planes[1].z, _planes[2].z, _planes[3].z, _planes[4].z, _planes[5].z, 0.0f, 0.0f);
+		__m256 const planeW = _mm256_setr_ps(_planes[0].w, _planes[1].w, _planes[2].w, _planes[3].w, _planes[4].w, _planes[5].w, 1.0f, 1.0f);
+
+		for (usize i = 0; i < _count; ++i)
+		{
+			Vec4 const& sphere = _spheres[i];
+			__m256 distance = _mm256_add_ps(_mm256_mul_ps(planeX, _mm256_set1_ps(sphere.x)), planeW);
+			distance = _mm256_add_ps(_mm256_mul_ps(planeY, _mm256_set1_ps(sphere.y)), distance);
+			distance = _mm256_add_ps(_mm256_mul_ps(planeZ, _mm256_set1_ps(sphere.z)), distance);
+			__m256 const outside = _mm256_cmp_ps(distance, _mm256_set1_ps(-sphere.w), _CMP_LT_OQ);
+			o_visible[i] = _mm256_movemask_ps(outside) == 0 ? 1 : 0;
+		}
+#elif __SSE2__
+		__m128 const planeX[2]{ _mm_setr_ps(_planes[0].x, _planes[1].x, _planes[2].x, _planes[3].x), _mm_setr_ps(_planes[4].x, _planes[5].x, 0.0f, 0.0f) };
+		__m128 const planeY[2]{ _mm_setr_ps(_planes[0].y, _planes[1].y, _planes[2].y, _planes[3].y), _mm_setr_ps(_planes[4].y, _planes[5].y, 0.0f, 0.0f) };
+		__m128 const planeZ[2]{ _mm_setr_ps(_planes[0].z, _planes[1].z, _planes[2].z, _planes[3].z), _mm_setr_ps(_planes[4].z, _planes[5].z, 0.0f, 0.0f) };
+		__m128 const planeW[2]{ _mm_setr_ps(_planes[0].w, _planes[1].w, _planes[2].w, _planes[3].w), _mm_setr_ps(_planes[4].w, _planes[5].w, 1.0f, 1.0f) };
+
+		for (usize i = 0; i < _count; ++i)
+		{
+			Vec4 const& sphere = _spheres[i];
+			__m128 const x = _mm_set1_ps(sphere.x);
+			__m128 const y = _mm_set1_ps(sphere.y);
+			__m128 const z = _mm_set1_ps(sphere.z);
+			__m128 const negRadius = _mm_set1_ps(-sphere.w);
+
+			int outsideMask = 0;
+			for (usize group = 0; group < 2; ++group)
+			{
+				__m128 distance = _mm_add_ps(_mm_mul_ps(planeX[group], x), planeW[group]);
+				distance = _mm_add_ps(_mm_mul_ps(planeY[group], y), distance);
+				distance = _mm_add_ps(_mm_mul_ps(planeZ[group], z), distance);
+				outsideMask |= _mm_movemask_ps(_mm_cmplt_ps(distance, negRadius));
+			}
+			o_visible[i] = outsideMask == 0 ? 1 : 0;
+		}
+#else
+		for (usize i = 0; i < _count; ++i)
+		{
+			Vec4 const& sphere = _spheres[i];
+			o_visible[i] = std::ranges::all_of(_planes, [&sphere](Vec4 const& _plane) { return glm::dot(Vec3(_plane), Vec3(sphere)) + _plane.w >= -sphere.w; }) ? 1 : 0;
+		}
+#endif
+	}
+}
\ No newline at end of file
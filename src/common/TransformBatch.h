@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.h"
+
+#include <array>
+
+// Batch versions of the per-transform matrix maths, for when a whole frame's worth of models need the same thing done.
+// Uses AVX when the build has it (USE_AVX, checked against Setup::CpuInfo at startup), otherwise SSE2.
+namespace TransformBatch
+{
+	// o_out[i] = _lhs[i] * _rhs[i], matching Trans::operator*. Can be done in place.
+	void Compose(Trans const* _lhs, Trans const* _rhs, usize _count, Trans* o_out);
+
+	// o_out[i] = _pre * _affine[i], where every _affine[i] has a bottom row of (0, 0, 0, 1), e.g. from GetRenderMatrix().
+	// _pre can be anything, e.g. a view or light-space matrix.
+	void MultiplyAffine(Mat4 const& _pre, Mat4 const* _affine, usize _count, Mat4* o_out);
+
+	// Inverse-transpose of the upper 3x3 of each matrix, padded to a Mat4. Only valid for transforming directions (w = 0).
+	// Degenerate matrices (e.g. a model scaled to zero) get the identity, so they don't fill the normals with infinities.
+	void GetNormalMatrices(Mat4 const* _matrices, usize _count, Mat4* o_out);
+
+	// World space bounding spheres (xyz centre, w radius) from model space ones. Scaling is allowed, the radius grows by the largest axis scale.
+	void TransformSpheres(Mat4 const* _affine, Vec4 const* _spheres, usize _count, Vec4* o_out);
+
+	// Inward facing planes of the volume that _clip (projection * view) maps to clip space, normalised so distances are in world units.
+	// Near uses the -w..w convention, which is conservative when the projection is 0..w.
+	std::array<Vec4, 6> GetFrustumPlanes(Mat4 const& _clip);
+
+	// o_visible[i] = 1 if _spheres[i] is at least partly inside every plane, 0 otherwise.
+	void CullSpheres(std::array<Vec4, 6> const& _planes, Vec4 const* _spheres, usize _count, uint8* o_visible);
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "systems/Core/PhysicsSystems.h"
 
 #include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
 
 #include <map>
 struct PhysicsWorldInternalData
@@ -25,9 +28,28 @@ namespace Core
 	void AddComponent(EntityID const _entity, Physics::World const& _component)
 	{
 		Physics::World newComponent = _component;
+#if !BT_THREADSAFE
+		// Only the headless build has a thread safe bullet (see CMakeLists.txt), so step like a single threaded world elsewhere.
+		kaAssert(!newComponent.m_multithreaded, "multithreaded worlds need BT_THREADSAFE");
+		newComponent.m_multithreaded = false;
+#endif
+		if (newComponent.m_multithreaded)
+		{
+			// The solver pool can't be swapped for another solver.
+			kaAssert(!newComponent.m_solver, "multithreaded worlds make their own solver");
+			kaAssert(newComponent.m_numThreads == Physics::GetWorldThreadCount(), "multithreaded worlds share one task scheduler, so must all use the thread count given to Physics::Init");
+		}
+
 		if (!newComponent.m_collisionConfiguration)
 		{
-			newComponent.m_collisionConfiguration = new btDefaultCollisionConfiguration();
+			btDefaultCollisionConstructionInfo constructionInfo{};
+			if (newComponent.m_multithreaded)
+			{
+				// threads allocate from these pools at once, and falling back to the heap past them is slow.
+				constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+				constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+			}
+			newComponent.m_collisionConfiguration = new btDefaultCollisionConfiguration(constructionInfo);
 		}
 		else
 		{
@@ -35,19 +57,30 @@ namespace Core
 		}
 		if (!newComponent.m_dispatcher)
 		{
-			newComponent.m_dispatcher = new btCollisionDispatcher(newComponent.m_collisionConfiguration);
+			newComponent.m_dispatcher = newComponent.m_multithreaded
+				? new btCollisionDispatcherMt(newComponent.m_collisionConfiguration)
+				: new btCollisionDispatcher(newComponent.m_collisionConfiguration);
 		}
 		if (!newComponent.m_overlappingPairCache)
 		{
 			newComponent.m_overlappingPairCache = new btDbvtBroadphase();
 		}
-		if (!newComponent.m_solver)
+		kaAssert(!newComponent.m_dynamicsWorld);
+		if (newComponent.m_multithreaded)
+		{
+			// one solver per thread, each solving its own islands.
+			btConstraintSolverPoolMt* const solverPool = new btConstraintSolverPoolMt(Physics::GetTaskScheduler()->getNumThreads());
+			newComponent.m_solver = solverPool;
+			newComponent.m_dynamicsWorld = new btDiscreteDynamicsWorldMt(newComponent.m_dispatcher, newComponent.m_overlappingPairCache, solverPool, nullptr, newComponent.m_collisionConfiguration);
+		}
+		else
 		{
-			newComponent.m_solver = new btSequentialImpulseConstraintSolver();
+			if (!newComponent.m_solver)
+			{
+				newComponent.m_solver = new btSequentialImpulseConstraintSolver();
+			}
+			newComponent.m_dynamicsWorld = new btDiscreteDynamicsWorld(newComponent.m_dispatcher, newComponent.m_overlappingPairCache, newComponent.m_solver, newComponent.m_collisionConfiguration);
 		}
-
-		kaAssert(!newComponent.m_dynamicsWorld);
-		newComponent.m_dynamicsWorld = new btDiscreteDynamicsWorld(newComponent.m_dispatcher, newComponent.m_overlappingPairCache, newComponent.m_solver, newComponent.m_collisionConfiguration);
 		newComponent.m_dynamicsWorld->setGravity(btVector3(0, -8.0f, 0));
 
 #if PHYSICS_DEBUG
@@ -111,7 +144,7 @@ namespace Core
 			newComponent.m_shape->calculateLocalInertia(mass, localInertia);
 		}
 
-		newComponent.m_motionState = new btDefaultMotionState(_desc.m_startTransform.GetBulletTransform());
+		newComponent.m_motionState = new Physics::InterpolatedMotionState(_desc.m_startTransform.GetBulletTransform());
 
 		// Finalise RB
 		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, newComponent.m_motionState, newComponent.m_shape, localInertia);
@@ -166,7 +199,7 @@ namespace Core
 		btVector3 localInertia(0, 0, 0);
 		newComponent.m_shape->calculateLocalInertia(mass, localInertia);
 
-		newComponent.m_motionState = new btDefaultMotionState(_desc.m_startTransform.GetBulletTransform());
+		newComponent.m_motionState = new Physics::InterpolatedMotionState(_desc.m_startTransform.GetBulletTransform());
 
 		// Finalise RB
 		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, newComponent.m_motionState, newComponent.m_shape, localInertia);
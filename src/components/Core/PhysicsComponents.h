@@ -5,14 +5,15 @@
 
 #include <ecs/flags.h>
 
+#include <LinearMath/btMotionState.h>
+
 // forward
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btBroadphaseInterface;
-class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
 class btDiscreteDynamicsWorld;
 class btCollisionShape;
-struct btDefaultMotionState;
 class btRigidBody;
 
 namespace Core
@@ -21,11 +22,54 @@ namespace Core
 	{
 		struct World
 		{
+			custom_add_component;
+
 			btDefaultCollisionConfiguration* m_collisionConfiguration{ nullptr };
 			btCollisionDispatcher* m_dispatcher{ nullptr };
 			btBroadphaseInterface* m_overlappingPairCache{ nullptr };
-			btSequentialImpulseConstraintSolver* m_solver{ nullptr };
+			btConstraintSolver* m_solver{ nullptr }; // a btConstraintSolverPoolMt when multithreaded
 			btDiscreteDynamicsWorld* m_dynamicsWorld{ nullptr };
+
+			// Builds a btDiscreteDynamicsWorldMt, which splits collision detection and solving across threads.
+			bool m_multithreaded{ false };
+			// Threads bullet splits work into when multithreaded, 0 for every hardware thread.
+			// Bullet has one task scheduler for every world, so this must match the count given to Physics::Init.
+			uint32 m_numThreads{ 0 };
+
+			// The world always steps by m_fixedStep, as many times as the accumulated frame time allows, up to m_maxStepsPerFrame.
+			// Time beyond that is dropped, so physics runs slow rather than spiralling when it can't keep up.
+			Vec1 m_fixedStep{ 1.0f / 60.0f };
+			uint32 m_maxStepsPerFrame{ 4 };
+			Vec1 m_accumulatedTime{ 0.0f };
+			// How far the leftover time is into the next step. Transforms are interpolated between the last two steps by this much.
+			Vec1 m_interpolation{ 0.0f };
+		};
+
+		// Keeps a body's last two physics states, so transforms can be interpolated between fixed steps.
+		class InterpolatedMotionState : public btMotionState
+		{
+			btTransform m_previous;
+			btTransform m_current;
+
+		public:
+			explicit InterpolatedMotionState(btTransform const& _start)
+				: m_previous{ _start }
+				, m_current{ _start }
+			{}
+
+			void getWorldTransform(btTransform& o_trans) const override { o_trans = m_current; }
+			// Called by bullet after a step moves the body.
+			void setWorldTransform(btTransform const& _trans) override { m_current = _trans; }
+
+			// Called before each step, so bodies which don't move during it aren't left interpolating from an older state.
+			void BeginStep() { m_previous = m_current; }
+			// For transforms set from outside physics, e.g. kinematic bodies, which shouldn't be interpolated.
+			void Reset(btTransform const& _trans) { m_previous = m_current = _trans; }
+
+			btTransform Interpolate(Vec1 _t) const
+			{
+				return btTransform(m_previous.getRotation().slerp(m_current.getRotation(), _t), m_previous.getOrigin().lerp(m_current.getOrigin(), _t));
+			}
 		};
 
 		enum class ShapeType
@@ -36,6 +80,8 @@ namespace Core
 
 		struct RigidBodyDesc
 		{
+			custom_add_component;
+
 			EntityID m_physicsWorld{};
 
 			bool m_isKinematic{ false };
@@ -57,12 +103,14 @@ namespace Core
 			EntityID m_physicsWorld{};
 
 			btCollisionShape* m_shape{ nullptr };
-			btDefaultMotionState* m_motionState{ nullptr };
+			InterpolatedMotionState* m_motionState{ nullptr };
 			btRigidBody* m_body{ nullptr };
 		};
 
 		struct CharacterControllerDesc
 		{
+			custom_add_component;
+
 			EntityID m_physicsWorld{};
 			EntityID m_viewObject{}; // local transform used for forward direction.
 
@@ -95,6 +143,10 @@ namespace Core
 	template<>
 	void AddComponent(EntityID const _entity, Physics::World const& _component);
 
+	// one-off component, not for bulk creation
+	template<>
+	void AddComponentToRange(EntityRange const _entities, Physics::World const& _component) = delete;
+
 	template<>
 	void CleanupComponent<Physics::World>(EntityID const _entity);
 
@@ -48,6 +48,8 @@ namespace Core
 
 		struct ModelDesc
 		{
+			custom_add_component;
+
 			std::string m_filePath;
 		};
 
@@ -61,6 +63,8 @@ namespace Core
 
 		struct SkyboxDesc
 		{
+			custom_add_component;
+
 			std::string m_cubemapPath;
 		};
 
@@ -73,6 +77,8 @@ namespace Core
 
 		struct SpriteDesc
 		{
+			custom_add_component;
+
 			using SpriteInit = std::variant< std::string, Resource::SpriteID >;
 			SpriteInit m_spriteInit;
 			Trans2D m_initTrans;
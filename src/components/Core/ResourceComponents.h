@@ -1,20 +1,13 @@
 #pragma once
 
 #include "common.h"
+#include "managers/ResourceIDs.h"
 
 namespace Core::Resource
 {
 	struct Preload
 	{
-		enum class FileType
-		{
-			Model,
-			Texture2D,
-			Cubemap,
-			Sprite,
-			SFX,
-			BGM,
-		};
+		using FileType = Resource::FileType;
 
 		struct FileToLoad
 		{
@@ -32,6 +25,9 @@ namespace Core::Resource
 		State m_preloadState{ State::LoadingScreenDraw };
 		std::optional<std::string> m_firstResFile;
 		std::vector<FileToLoad> m_filesToLoad;
-		usize m_currentLoadingIndex{ 0 };
+		usize m_currentLoadingIndex{ 0 }; // files are loaded asynchronously, so this is the number finished rather than which is in progress.
+#if DEBUG_TOOLS
+		uint64 m_debug_startTicks{ 0 };
+#endif
 	};
 }
\ No newline at end of file
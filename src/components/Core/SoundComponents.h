@@ -43,6 +43,8 @@ namespace Core::Sound
 
 	struct BGMDesc
 	{
+		custom_add_component;
+
 		std::string m_filePath;
 		Vec1 m_initVolume{ -1.0f };
 	};
@@ -56,6 +58,8 @@ namespace Core::Sound
 
 	struct SoundEffect3DDesc
 	{
+		custom_add_component;
+
 		std::string m_filePath;
 		Vec1 m_initVolume{ -1.0f };
 	};
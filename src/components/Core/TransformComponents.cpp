@@ -0,0 +1,90 @@
+#include "TransformComponents.h"
+
+namespace Core
+{
+	void SetParent3D
+	(
+		Core::EntityID _entity,
+		Core::EntityID _newParent
+	)
+	{
+		Transform3D* const transform = Core::GetComponent<Transform3D>( _entity );
+		kaAssert( transform != nullptr );
+		EntityManagement::ChangeParent( _entity, transform->m_parent, _newParent );
+		transform->m_parent = _newParent;
+		transform->MarkDirty();
+	}
+
+	void SetParent2D
+	(
+		Core::EntityID _entity,
+		Core::EntityID _newParent
+	)
+	{
+		Transform2D* const transform = Core::GetComponent<Transform2D>( _entity );
+		kaAssert( transform != nullptr );
+		EntityManagement::ChangeParent( _entity, transform->m_parent, _newParent );
+		transform->m_parent = _newParent;
+		transform->MarkDirty();
+	}
+
+	template<>
+	void AddComponent( EntityID const _entity, Transform3D const& _component )
+	{
+		EntityManagement::ChangeParent( _entity, Core::EntityID{}, _component.GetParent() );
+		Transform3D::MarkDescendantDirty( _component.GetParent() );
+		Core::ECS::AddComponent( _entity, _component );
+	}
+
+	template<>
+	void AddComponentToRange( EntityRange const _entities, Transform3D const& _component )
+	{
+		if ( _component.GetParent().IsValid() )
+		{
+			for ( uint32 i = 0; i < _entities.Count(); ++i )
+			{
+				EntityManagement::ChangeParent( _entities[i], Core::EntityID{}, _component.GetParent() );
+			}
+			Transform3D::MarkDescendantDirty( _component.GetParent() );
+		}
+		Core::ECS::AddComponentToRange( _entities, _component );
+	}
+
+	template<>
+	void CleanupComponent<Transform3D>( EntityID const _entity )
+	{
+		Transform3D const* const oldComponent = Core::GetComponent<Transform3D>( _entity );
+		kaAssert( oldComponent );
+		EntityManagement::ChangeParent( _entity, oldComponent->GetParent(), Core::EntityID{} );
+	}
+
+	template<>
+	void AddComponent( EntityID const _entity, Transform2D const& _component )
+	{
+		EntityManagement::ChangeParent( _entity, Core::EntityID{}, _component.GetParent() );
+		Transform2D::MarkDescendantDirty( _component.GetParent() );
+		Core::ECS::AddComponent( _entity, _component );
+	}
+
+	template<>
+	void AddComponentToRange( EntityRange const _entities, Transform2D const& _component )
+	{
+		if ( _component.GetParent().IsValid() )
+		{
+			for ( uint32 i = 0; i < _entities.Count(); ++i )
+			{
+				EntityManagement::ChangeParent( _entities[i], Core::EntityID{}, _component.GetParent() );
+			}
+			Transform2D::MarkDescendantDirty( _component.GetParent() );
+		}
+		Core::ECS::AddComponentToRange( _entities, _component );
+	}
+
+	template<>
+	void CleanupComponent<Transform2D>( EntityID const _entity )
+	{
+		Transform2D const* const oldComponent = Core::GetComponent<Transform2D>( _entity );
+		kaAssert( oldComponent );
+		EntityManagement::ChangeParent( _entity, oldComponent->GetParent(), Core::EntityID{} );
+	}
+}
\ No newline at end of file
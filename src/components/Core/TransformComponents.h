@@ -4,6 +4,8 @@
 #include "managers/EntityManager.h"
 #include "common.h"
 
+#include <atomic>
+
 namespace Core
 {
 	// Transform types split between 'normal' (3D) and '2D' (sprites only).
@@ -13,10 +15,24 @@ namespace Core
 	// Used by non-sprites
 	struct Transform3D
 	{
+		custom_add_component;
+
+	private:
 		// origin = position, basis = rotation
 		Trans m_transform{};
+
+		// Cached by the world transform pass. Anything that could change the local transform or parent marks it dirty.
+		Trans m_worldTransform{};
+		bool m_dirty{ true };
+		// Set on every ancestor of a dirty transform, so the pass can skip subtrees where nothing changed. Only accessed atomically outside the pass.
+		alignas(std::atomic_ref<bool>::required_alignment) bool m_descendantDirty{ false };
+		friend bool UpdateWorldTransforms3D(Core::EntityID _entity, Transform3D& io_transform, Trans const* _parentWorld, bool _parentChanged);
+
+		// Only changed through SetParent3D, so the entity manager's parent->children index stays in sync.
+		friend void SetParent3D(Core::EntityID _entity, Core::EntityID _newParent);
 		Core::EntityID m_parent;
 
+	public:
 		Transform3D(Core::EntityID _parent = Core::EntityID{})
 			: m_parent{ _parent }
 		{}
@@ -33,16 +49,39 @@ namespace Core
 			, m_parent{ _parent }
 		{}
 
-		// shorthand accessor
-		Trans& T() { return m_transform; }
+		// shorthand accessor, read only. Use Modify or SetLocal to change the transform, so that the world transform pass picks it up.
 		Trans const& T() const { return m_transform; }
 
-		void DetachFromParent()
+		// Marks the transform dirty, so only call it when actually writing through the result.
+		Trans& Modify() { MarkDirty(); return m_transform; }
+		void SetLocal(Trans const& _t) { m_transform = _t; MarkDirty(); }
+
+		void MarkDirty()
 		{
-			m_transform = CalculateWorldTransform();
-			m_parent = Core::EntityID();
+			m_dirty = true;
+			MarkDescendantDirty(m_parent);
+		}
+
+		// Flags _entity and its ancestors. Stops at the first one that's already flagged, as everything above it will be too.
+		// Ancestors added this frame aren't found, but they're dirty themselves and will walk all their children.
+		static void MarkDescendantDirty(Core::EntityID _entity)
+		{
+			for (Core::EntityID next = _entity; next.IsValid();)
+			{
+				Transform3D* const transform = Core::GetComponent<Transform3D>(next);
+				if (transform == nullptr || std::atomic_ref<bool>{ transform->m_descendantDirty }.exchange(true, std::memory_order_relaxed))
+				{
+					break;
+				}
+				next = transform->m_parent;
+			}
 		}
 
+		Core::EntityID GetParent() const { return m_parent; }
+
+		// World transform as of the last world transform pass. Prefer this over CalculateWorldTransform in systems that run after the pass.
+		Trans const& GetWorldTransform() const { return m_worldTransform; }
+
 		void SetLocalTransformFromWorldTransform(Trans const& _worldTransform)
 		{
 			Core::EntityID nextParent = m_parent;
@@ -57,6 +96,7 @@ namespace Core
 			}
 
 			m_transform = finalTransform.ToLocal(_worldTransform);
+			MarkDirty();
 		}
 
 		Trans CalculateWorldTransform() const
@@ -89,9 +129,23 @@ namespace Core
 	// Used by sprites
 	struct Transform2D
 	{
+		custom_add_component;
+
+	private:
 		Trans2D m_transform;
+
+		// Cached by the world transform pass. Anything that could change the local transform or parent marks it dirty.
+		Trans2D m_worldTransform{};
+		bool m_dirty{ true };
+		// Set on every ancestor of a dirty transform, so the pass can skip subtrees where nothing changed. Only accessed atomically outside the pass.
+		alignas(std::atomic_ref<bool>::required_alignment) bool m_descendantDirty{ false };
+		friend bool UpdateWorldTransforms2D(Core::EntityID _entity, Transform2D& io_transform, Trans2D const* _parentWorld, bool _parentChanged);
+
+		// Only changed through SetParent2D, so the entity manager's parent->children index stays in sync.
+		friend void SetParent2D(Core::EntityID _entity, Core::EntityID _newParent);
 		Core::EntityID m_parent;
 
+	public:
 		Transform2D(Core::EntityID _parent = Core::EntityID{})
 			: m_parent{ _parent }
 		{}
@@ -100,16 +154,39 @@ namespace Core
 			, m_parent{ _parent }
 		{}
 
-		// shorthand accessor
-		Trans2D& T() { return m_transform; }
+		// shorthand accessor, read only. Use Modify or SetLocal to change the transform, so that the world transform pass picks it up.
 		Trans2D const& T() const { return m_transform; }
 
-		void DetachFromParent()
+		// Marks the transform dirty, so only call it when actually writing through the result.
+		Trans2D& Modify() { MarkDirty(); return m_transform; }
+		void SetLocal(Trans2D const& _t) { m_transform = _t; MarkDirty(); }
+
+		void MarkDirty()
+		{
+			m_dirty = true;
+			MarkDescendantDirty(m_parent);
+		}
+
+		// Flags _entity and its ancestors. Stops at the first one that's already flagged, as everything above it will be too.
+		// Ancestors added this frame aren't found, but they're dirty themselves and will walk all their children.
+		static void MarkDescendantDirty(Core::EntityID _entity)
 		{
-			m_transform = CalculateWorldTransform();
-			m_parent = Core::EntityID();
+			for (Core::EntityID next = _entity; next.IsValid();)
+			{
+				Transform2D* const transform = Core::GetComponent<Transform2D>(next);
+				if (transform == nullptr || std::atomic_ref<bool>{ transform->m_descendantDirty }.exchange(true, std::memory_order_relaxed))
+				{
+					break;
+				}
+				next = transform->m_parent;
+			}
 		}
 
+		Core::EntityID GetParent() const { return m_parent; }
+
+		// World transform as of the last world transform pass. Prefer this over CalculateWorldTransform in systems that run after the pass.
+		Trans2D const& GetWorldTransform() const { return m_worldTransform; }
+
 		void SetLocalTransformFromWorldTransform(Trans2D const& _worldTransform)
 		{
 			Core::EntityID nextParent = m_parent;
@@ -124,6 +201,7 @@ namespace Core
 			}
 
 			m_transform = finalTransform.ToLocal(_worldTransform);
+			MarkDirty();
 		}
 
 		Trans2D CalculateWorldTransform() const
@@ -157,21 +235,63 @@ namespace Core
 
 	inline Trans GetTransform3D( Core::EntityID _entity )
 	{
-		return Core::GetComponent<Transform3D>( _entity )->m_transform;
+		Transform3D const* const transform = Core::GetComponent<Transform3D>( _entity );
+		return transform->T();
 	}
 
 	inline Trans2D GetTransform2D( Core::EntityID _entity )
 	{
-		return Core::GetComponent<Transform2D>( _entity )->m_transform;
+		Transform2D const* const transform = Core::GetComponent<Transform2D>( _entity );
+		return transform->T();
 	}
 
 	inline void SetTransform3D( Core::EntityID _entity, Trans const& _newTrans )
 	{
-		Core::GetComponent<Transform3D>( _entity )->m_transform = _newTrans;
+		Core::GetComponent<Transform3D>( _entity )->SetLocal( _newTrans );
 	}
 
 	inline void SetTransform2D( Core::EntityID _entity, Trans2D const& _newTrans )
 	{
-		Core::GetComponent<Transform2D>( _entity )->m_transform = _newTrans;
+		Core::GetComponent<Transform2D>( _entity )->SetLocal( _newTrans );
+	}
+
+	// Re-parenting keeps the local transform as-is, so the entity will likely move in world space.
+	void SetParent3D( Core::EntityID _entity, Core::EntityID _newParent );
+	void SetParent2D( Core::EntityID _entity, Core::EntityID _newParent );
+
+	// Keeps the world transform, but removes the parent.
+	inline void DetachFromParent3D( Core::EntityID _entity )
+	{
+		Transform3D* const transform = Core::GetComponent<Transform3D>( _entity );
+		kaAssert( transform != nullptr );
+		transform->SetLocal( transform->CalculateWorldTransform() );
+		SetParent3D( _entity, Core::EntityID{} );
 	}
+
+	inline void DetachFromParent2D( Core::EntityID _entity )
+	{
+		Transform2D* const transform = Core::GetComponent<Transform2D>( _entity );
+		kaAssert( transform != nullptr );
+		transform->SetLocal( transform->CalculateWorldTransform() );
+		SetParent2D( _entity, Core::EntityID{} );
+	}
+
+	// Parented transforms register with the entity manager's hierarchy so that destroying a parent can find its children directly.
+	template<>
+	void AddComponent( EntityID const _entity, Transform3D const& _component );
+
+	template<>
+	void AddComponentToRange( EntityRange const _entities, Transform3D const& _component );
+
+	template<>
+	void CleanupComponent<Transform3D>( EntityID const _entity );
+
+	template<>
+	void AddComponent( EntityID const _entity, Transform2D const& _component );
+
+	template<>
+	void AddComponentToRange( EntityRange const _entities, Transform2D const& _component );
+
+	template<>
+	void CleanupComponent<Transform2D>( EntityID const _entity );
 }
\ No newline at end of file
@@ -322,6 +322,9 @@ void AddComponent
 		}
 	}
 
+	// The scene copies texture and UVs when a sprite is added, so pack the cards first if the preload didn't already.
+	Core::Resource::PackSpriteAtlases();
+
 	for ( usize cardI = 0; cardI < 52; ++cardI )
 	{
 		newComponent.m_cards[ cardI ].m_cardFront = Core::Render::AddSpriteToScene( cardFronts[ cardI ], Trans2D(), SpriteFlag_Hidden );
@@ -202,6 +202,8 @@ struct GameData
 
 struct GameRender
 {
+	custom_add_component;
+
 	struct CardRender
 	{
 		Core::Render::SpriteSceneID m_cardFront;
@@ -243,4 +245,8 @@ namespace Core
 {
 template<>
 void AddComponent( EntityID const _entity, Game::GinRummy::GameRender const& _component );
+
+// one-off component, not for bulk creation
+template<>
+void AddComponentToRange( EntityRange const _entities, Game::GinRummy::GameRender const& _component ) = delete;
 }
\ No newline at end of file
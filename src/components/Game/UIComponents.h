@@ -23,6 +23,8 @@ namespace Game::UI
 
 	struct SceneLoadDesc
 	{
+		custom_add_component;
+
 		std::shared_ptr< Core::Scene::BaseScene > m_nextScene;
 	};
 }
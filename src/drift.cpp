@@ -10,7 +10,9 @@
 #include "systems.h"
 
 #include "cpuid.h"
+#if !DRIFT_HEADLESS
 #include <boxer/boxer.h>
+#endif
 
 // sokol
 #include <sokol_app.h>
@@ -20,6 +22,17 @@
 #include "scenes/GinRummy.h"
 
 #include <format>
+#if DRIFT_HEADLESS
+#include "HeadlessBenchmarks.h"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#endif
 
 constexpr int32 g_renderAreaWidth = 320;
 constexpr int32 g_renderAreaHeight = (g_renderAreaWidth / 4) * 3;
@@ -32,6 +45,12 @@ void Cleanup();
 void Event(sapp_event const* _event);
 void Fail(char const* _error);
 
+static std::shared_ptr<Core::Scene::BaseScene> g_startScene; // CubeTest if not chosen before Initialise
+static std::optional<uint32> g_physicsThreads; // makes the primary physics world multithreaded if set before Initialise, 0 for every hardware thread
+#if DRIFT_HEADLESS
+static constexpr dVec1 c_headlessFrameTime = 1.0 / 60.0;
+#endif
+
 bool EnsureRequiredCPUFeatures(char const*& o_missingFeature)
 {
 	Setup::CpuInfo cpuInfo;
@@ -46,6 +65,7 @@ bool EnsureRequiredCPUFeatures(char const*& o_missingFeature)
 	return true;
 }
 
+#if !DRIFT_HEADLESS
 sapp_desc sokol_main(int argc, char* argv[])
 {
 	{
@@ -76,6 +96,7 @@ sapp_desc sokol_main(int argc, char* argv[])
 
 	return desc;
 }
+#endif
 
 void Initialise()
 {
@@ -86,12 +107,13 @@ void Initialise()
 		Core::Render::TextAndGLDebug::Init();
 		Core::Render::DImGui::Init();
 		Core::Sound::Init();
-		Core::Physics::Init();
+		Core::Physics::Init(g_physicsThreads.value_or(0));
 		stm_setup();
 	}
 
 	// system and data setup
 	{
+		Core::Profiling::Setup(); // before anything else makes systems
 		Core::Resource::SetupData();
 		Core::Render::SetupPipeline(g_renderAreaWidth, g_renderAreaHeight);
 		Core::Render::Setup();
@@ -100,6 +122,7 @@ void Initialise()
 		Core::Resource::Setup();
 		Core::Sound::Setup();
 		Core::Physics::Setup();
+		Core::Transforms::Setup();
 		Core::Input::Setup(g_renderAreaWidth, g_renderAreaHeight);
 	}
 
@@ -115,7 +138,7 @@ void Initialise()
 	// pre-scene required entity setup
 	{
 		Core::EntityID const primaryPhysicsWorld = Core::CreatePersistentEntity();
-		Core::AddComponent(primaryPhysicsWorld, Core::Physics::World{});
+		Core::AddComponent(primaryPhysicsWorld, Core::Physics::World{ .m_multithreaded = g_physicsThreads.has_value(), .m_numThreads = g_physicsThreads.value_or(0), });
 
 		Core::ECS::CommitChanges();
 	}
@@ -147,7 +170,7 @@ void Initialise()
 	{
 		Core::EntityID const preloadEntity = Core::CreateEntity();
 		Game::UI::SceneLoadDesc startScene;
-		startScene.m_nextScene = std::make_shared<Game::Scene::CubeTestScene>();
+		startScene.m_nextScene = g_startScene != nullptr ? g_startScene : std::make_shared<Game::Scene::CubeTestScene>();
 		Core::AddComponent( preloadEntity, startScene );
 	}
 
@@ -159,9 +182,14 @@ void Frame()
 {
 	{
 		Core::FrameData& fd = Core::GetGlobalComponent<Core::FrameData>();
+#if DRIFT_HEADLESS
+		// fixed steps, so runs are comparable however long each frame actually took
+		fd.unscaled_ddt = c_headlessFrameTime;
+#else
 		uint64 const lappedTicks = stm_laptime(&fd.m_lastFrameTicks);
 		// stm_round_to_common_refresh_rate?
 		fd.unscaled_ddt = stm_sec(lappedTicks);
+#endif
 		fd.unscaled_dt = static_cast< Vec1 >(fd.unscaled_ddt);
 		fd.ddt = fd.m_scale * fd.unscaled_ddt;
 		fd.dt = static_cast< Vec1 >(fd.ddt);
@@ -184,7 +212,10 @@ void Frame()
 
 	Core::Input::Update();
 
+	Core::Render::StartFrame();
 	Core::ECS::Update();
+
+	Core::Profiling::FrameEnd();
 }
 
 void Cleanup()
@@ -209,4 +240,165 @@ void Event(sapp_event const* _event)
 void Fail(char const* _error)
 {
 	kaError(_error);
-}
\ No newline at end of file
+}
+
+#if DRIFT_HEADLESS
+//--------------------------------------------------------------------------------
+// Runs the game with no window or GPU for a number of frames, then prints the average time spent in each system group and the average render stats.
+// usage: drift_headless [--frames N] [--warmup N] [--scene cubetest|cubestress|ginrummy] [--physics-threads N] [--compressed-textures 0|1] [--trace path] [--bench name]
+// Warmup frames (which cover preloading) aren't included in the timings. --trace also writes the timed frames out as a Chrome trace.
+// --physics-threads uses bullet's multithreaded world with N threads, 0 for every hardware thread.
+// --compressed-textures 0 loads material textures uncompressed, to compare startup time and texture memory against the cooked block compressed ones.
+// --bench runs one of the microbenchmarks in HeadlessBenchmarks.cpp instead of any frames.
+int main(int argc, char* argv[])
+{
+	uint32 numFrames{ 1000 };
+	uint32 numWarmupFrames{ 100 };
+	std::string tracePath;
+	std::string benchName;
+	std::optional<bool> useCompressedTextures;
+	for (int argI = 1; argI + 1 < argc; argI += 2)
+	{
+		std::string_view const option = argv[argI];
+		std::string_view const value = argv[argI + 1];
+		auto const parseCount = [&value](uint32& o_count)
+		{
+			return std::from_chars(value.data(), value.data() + value.size(), o_count).ec == std::errc{};
+		};
+
+		bool valid{ false };
+		if (option == "--frames")
+		{
+			valid = parseCount(numFrames);
+		}
+		else if (option == "--warmup")
+		{
+			valid = parseCount(numWarmupFrames);
+		}
+		else if (option == "--physics-threads")
+		{
+			uint32 numThreads{ 0 };
+			valid = parseCount(numThreads);
+			g_physicsThreads = numThreads;
+		}
+		else if (option == "--compressed-textures")
+		{
+			valid = value == "0" || value == "1";
+			useCompressedTextures = value == "1";
+		}
+		else if (option == "--trace")
+		{
+			tracePath = value;
+			valid = !tracePath.empty();
+		}
+		else if (option == "--bench")
+		{
+			benchName = value;
+			valid = !benchName.empty();
+		}
+		else if (option == "--scene")
+		{
+			if (value == "cubetest")
+			{
+				g_startScene = std::make_shared<Game::Scene::CubeTestScene>();
+				valid = true;
+			}
+			else if (value == "cubestress")
+			{
+				g_startScene = std::make_shared<Game::Scene::CubeStressScene>();
+				valid = true;
+			}
+			else if (value == "ginrummy")
+			{
+				g_startScene = std::make_shared<Game::Scene::GinRummy>();
+				valid = true;
+			}
+		}
+
+		if (!valid)
+		{
+			std::cerr << std::format("Bad option {:s} {:s}\nusage: drift_headless [--frames N] [--warmup N] [--scene cubetest|cubestress|ginrummy] [--physics-threads N] [--compressed-textures 0|1] [--trace path] [--bench {:s}]\n", option, value, Bench::GetNames());
+			return 1;
+		}
+	}
+
+	{
+		char const* missingFeature{ nullptr };
+		if (!EnsureRequiredCPUFeatures(missingFeature))
+		{
+			std::cerr << std::format("Missing the '{:s}' CPU feature, which is required with this build.\n", missingFeature);
+			return 1;
+		}
+	}
+
+	InitialiseLogging();
+	Initialise();
+	if (useCompressedTextures.has_value())
+	{
+		Core::Resource::SetUseCompressedTextures(*useCompressedTextures);
+	}
+
+	if (!benchName.empty())
+	{
+		Bench::Result const benchResult = Bench::Run(benchName);
+		if (benchResult == Bench::Result::UnknownName)
+		{
+			std::cerr << std::format("No benchmark called {:s}, try one of {:s}\n", benchName, Bench::GetNames());
+		}
+		Cleanup();
+		return benchResult == Bench::Result::Passed ? 0 : 1;
+	}
+
+	Core::Render::FrameStats totalRenderStats{};
+	for (uint32 frameI = 0; frameI < numWarmupFrames + numFrames; ++frameI)
+	{
+		if (frameI == numWarmupFrames)
+		{
+			Core::Profiling::ResetTotals();
+			if (!tracePath.empty() && numFrames > 0)
+			{
+				Core::Profiling::CaptureTrace(tracePath, numFrames);
+			}
+		}
+		Frame();
+		if (frameI >= numWarmupFrames)
+		{
+			totalRenderStats += Core::Render::GetFrameStats();
+		}
+	}
+
+	Core::Profiling::GroupTimings const& totals = Core::Profiling::GetTotalTimings();
+	dVec1 const frameCount = static_cast<dVec1>(std::max<uint64>(Core::Profiling::GetTotalFrameCount(), 1));
+	dVec1 totalMs{ 0.0 };
+	std::cout << std::format("{:d} frames, average ms per frame:\n", Core::Profiling::GetTotalFrameCount());
+	for (usize group = 0; group < Sys::COUNT; ++group)
+	{
+		std::cout << std::format("{:<28s}{:10.4f}\n", Sys::c_sysOrderingNames[group], totals[group] / frameCount);
+		totalMs += totals[group];
+	}
+	std::cout << std::format("{:<28s}{:10.4f}\n", "total", totalMs / frameCount);
+
+	std::cout << "\naverage render stats per frame:\n";
+	std::pair<char const*, usize> const renderStats[] = {
+		{ "draw calls", totalRenderStats.m_drawCalls },
+		{ "uniform applies", totalRenderStats.m_uniformApplies },
+		{ "bindings applied", totalRenderStats.m_bindingsApplied },
+		{ "pass switches", totalRenderStats.m_passSwitches },
+		{ "bytes uploaded", totalRenderStats.m_bytesUploaded },
+		{ "vertices", totalRenderStats.m_verticesSubmitted },
+		{ "indices", totalRenderStats.m_indicesSubmitted },
+		{ "sprite batches", totalRenderStats.m_spriteBatches },
+		{ "meshes queued", totalRenderStats.m_submittedMeshes },
+		{ "shadow meshes drawn", totalRenderStats.m_shadowMeshesDrawn },
+		{ "main meshes drawn", totalRenderStats.m_mainMeshesDrawn },
+	};
+	for (auto const& [name, total] : renderStats)
+	{
+		std::cout << std::format("{:<28s}{:10.1f}\n", name, static_cast<dVec1>(total) / frameCount);
+	}
+	std::cout << std::format("\n{:<28s}{:10.1f}\n", "texture memory MB", static_cast<dVec1>(Core::Resource::GetTotalTextureBytes()) / (1024.0 * 1024.0));
+
+	Cleanup();
+	return 0;
+}
+#endif
\ No newline at end of file
@@ -5,6 +5,14 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/container/inlined_vector.h>
+
+#include <sokol_time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 
 
 ecs::runtime& Core::detail::GetEcsRuntime()
@@ -18,31 +26,301 @@ namespace Core
 {
 	namespace EntityManagement
 	{
-		struct ComponentChange
+		static usize GetEntityIndex
+		(
+			EntityID _entity
+		)
 		{
-			ComponentHash m_hash;
-			bool m_added;
+			return static_cast<usize>(_entity.GetIndex());
+		}
+
+		// Fixed-width set of component type indices. Small enough to store by value per entity, and cheap to scan.
+		class ComponentMask
+		{
+			static constexpr usize c_bitsPerWord = 64;
+			static constexpr usize c_numWords = (c_maxComponentTypes + c_bitsPerWord - 1) / c_bitsPerWord;
+			std::array<uint64, c_numWords> m_words{};
+
+		public:
+			bool Test(ComponentTypeIndex _i) const { return (m_words[_i / c_bitsPerWord] & (uint64{ 1 } << (_i % c_bitsPerWord))) != 0; }
+			void Set(ComponentTypeIndex _i) { m_words[_i / c_bitsPerWord] |= (uint64{ 1 } << (_i % c_bitsPerWord)); }
+			void Reset() { m_words = {}; }
+
+			bool None() const
+			{
+				for (uint64 const word : m_words)
+				{
+					if (word != 0) { return false; }
+				}
+				return true;
+			}
+
+			bool Intersects(ComponentMask const& _o) const
+			{
+				for (usize w = 0; w < c_numWords; ++w)
+				{
+					if ((m_words[w] & _o.m_words[w]) != 0) { return true; }
+				}
+				return false;
+			}
+
+			// true if every bit set in this is also set in _o
+			bool SubsetOf(ComponentMask const& _o) const
+			{
+				for (usize w = 0; w < c_numWords; ++w)
+				{
+					if ((m_words[w] & ~_o.m_words[w]) != 0) { return false; }
+				}
+				return true;
+			}
+
+			ComponentMask& operator|=(ComponentMask const& _o)
+			{
+				for (usize w = 0; w < c_numWords; ++w) { m_words[w] |= _o.m_words[w]; }
+				return *this;
+			}
+
+			ComponentMask& RemoveAll(ComponentMask const& _o)
+			{
+				for (usize w = 0; w < c_numWords; ++w) { m_words[w] &= ~_o.m_words[w]; }
+				return *this;
+			}
+
+			// Visits set bits, lowest index first
+			template<typename T_Fn>
+			void ForEach(T_Fn const& _fn) const
+			{
+				for (usize w = 0; w < c_numWords; ++w)
+				{
+					for (uint64 word = m_words[w]; word != 0; word &= word - 1)
+					{
+						_fn(static_cast<ComponentTypeIndex>(w * c_bitsPerWord + std::countr_zero(word)));
+					}
+				}
+			}
 
-			ComponentChange(ComponentHash _hash, bool _added) : m_hash{ _hash }, m_added{ _added } {}
+			// Visits set bits, highest index first
+			template<typename T_Fn>
+			void ForEachReverse(T_Fn const& _fn) const
+			{
+				for (usize w = c_numWords; w-- > 0;)
+				{
+					for (uint64 word = m_words[w]; word != 0;)
+					{
+						usize const bit = c_bitsPerWord - 1 - std::countl_zero(word);
+						word &= ~(uint64{ 1 } << bit);
+						_fn(static_cast<ComponentTypeIndex>(w * c_bitsPerWord + bit));
+					}
+				}
+			}
 		};
 
-		absl::flat_hash_map<ComponentHash, std::unique_ptr<ComponentDestroyerBase>> g_destroyers{};
+		// Indexed by ComponentTypeIndex. Fixed size so lookups never race with a registration reallocating.
+		static std::array<std::unique_ptr<ComponentDestroyerBase>, c_maxComponentTypes> g_destroyers{};
+
+		struct ComponentTypeRegistry
+		{
+			absl::flat_hash_map<ComponentHash, ComponentTypeIndex> m_indices{};
+			ComponentTypeIndex m_count{ 0 };
+		};
+		static Mutex< ComponentTypeRegistry > g_componentTypes;
+
+		struct EntityComponents
+		{
+			ComponentMask m_committed{};
+			ComponentMask m_added{}; // uncommitted
+			ComponentMask m_removed{}; // uncommitted
+
+			bool HasUncommittedChanges() const { return !m_added.None() || !m_removed.None(); }
+		};
 
 		struct ComponentChangeData
 		{
-			absl::flat_hash_map<EntityID, std::vector<ComponentChange>> m_uncommittedChanges{};
-			absl::flat_hash_map<EntityID, std::vector<ComponentHash>> m_committed{};
+			// Indexed by entity value. IDs are handed out densely so this stays compact.
+			std::vector<EntityComponents> m_entities{};
+			std::vector<EntityID> m_changedEntities{};
+
+			EntityComponents& Get(EntityID _entity)
+			{
+				usize const entityI = GetEntityIndex(_entity);
+				if (entityI >= m_entities.size())
+				{
+					m_entities.resize(entityI + 1);
+				}
+				return m_entities[entityI];
+			}
+
+			EntityComponents* Find(EntityID _entity)
+			{
+				usize const entityI = GetEntityIndex(_entity);
+				return entityI < m_entities.size() ? &m_entities[entityI] : nullptr;
+			}
 		};
 		static RecursiveMutex< ComponentChangeData > g_componentChangeData;
 
+		struct ComponentChange
+		{
+			EntityRange m_entities; // usually just one, but bulk creation adds to a whole range at once
+			ComponentTypeIndex m_typeIndex;
+			bool m_added;
+
+			ComponentChange(EntityRange _entities, ComponentTypeIndex _typeIndex, bool _added) : m_entities{ _entities }, m_typeIndex{ _typeIndex }, m_added{ _added } {}
+		};
+
+		// Per-thread, append-only list of structural changes, merged in one go by CommitChanges.
+		// The mutex is only ever contended by the merge, so parallel systems adding/removing components don't serialise on each other.
+		struct ComponentChangeJournal
+		{
+			absl::Mutex m_mutex;
+			std::vector<ComponentChange> m_changes;
+		};
+
+		// Journals are owned here rather than by the thread so that they survive worker threads shutting down before the final commit.
+		static Mutex< std::vector<std::unique_ptr<ComponentChangeJournal>> > g_journals;
+
+		static ComponentChangeJournal& GetThreadJournal()
+		{
+			thread_local ComponentChangeJournal* t_journal{ nullptr };
+			if (t_journal == nullptr)
+			{
+				t_journal = g_journals.Write()->emplace_back(std::make_unique<ComponentChangeJournal>()).get();
+			}
+			return *t_journal;
+		}
+
+		// Current generation of every entity index. Paged so it can grow without moving, which lets IsValid read it without taking the entity data lock.
+		// Only written with the entity data write lock held.
+		class GenerationTable
+		{
+			static constexpr uint32 c_pageBits = 16;
+			static constexpr uint32 c_pageSize = 1u << c_pageBits;
+			static constexpr uint32 c_numPages = (EntityID::c_maxIndex >> c_pageBits) + 1;
+			using Page = std::array<std::atomic<uint32>, c_pageSize>;
+
+			std::array<std::atomic<Page*>, c_numPages> m_pages{};
+
+		public:
+			~GenerationTable()
+			{
+				for (std::atomic<Page*>& page : m_pages)
+				{
+					delete page.load(std::memory_order_relaxed);
+				}
+			}
+
+			uint32 Get(uint32 _index) const
+			{
+				Page const* const page = m_pages[_index >> c_pageBits].load(std::memory_order_acquire);
+				return page != nullptr ? (*page)[_index & (c_pageSize - 1)].load(std::memory_order_relaxed) : 0;
+			}
+
+			void EnsureRange(uint32 _first, uint32 _count)
+			{
+				for (uint32 p = _first >> c_pageBits; p <= (_first + _count - 1) >> c_pageBits; ++p)
+				{
+					if (m_pages[p].load(std::memory_order_relaxed) == nullptr)
+					{
+						m_pages[p].store(new Page{}, std::memory_order_release);
+					}
+				}
+			}
+
+			void Bump(uint32 _index)
+			{
+				std::atomic<uint32>& generation = (*m_pages[_index >> c_pageBits].load(std::memory_order_relaxed))[_index & (c_pageSize - 1)];
+				generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+		};
+		static GenerationTable g_generations;
+
 		struct EntityData
 		{
 			absl::flat_hash_set<EntityID> m_active;
 			absl::flat_hash_set<EntityID> m_sceneActive;
 
+			// Destroyed indices waiting to be reused, so the ID space (and everything indexed by it) stays dense.
+			std::vector<uint32> m_freeIndices;
+			uint32 m_nextIndex{ 0 };
+
+			// Indexed by entity index. Lets entities be destroyed newest first, which the index can't tell once it's been recycled.
+			std::vector<uint64> m_creationOrder;
+			uint64 m_nextCreationOrder{ 0 };
+
+			EntityID AllocateID()
+			{
+				if (!m_freeIndices.empty())
+				{
+					uint32 const index = m_freeIndices.back();
+					m_freeIndices.pop_back();
+					return EntityID::Make(index, g_generations.Get(index));
+				}
+
+				kaAssert(m_nextIndex < EntityID::c_maxIndex, "ran out of entity IDs");
+				g_generations.EnsureRange(m_nextIndex, 1);
+				return EntityID::Make(m_nextIndex++, 0);
+			}
+
+			// Ranges must be contiguous for the ecs runtime. They're taken from the first run of free indices long enough, so churning
+			// through CreateEntities doesn't grow the index space. Failing that, a free run at the end of the used indices is extended with never-used ones.
+			EntityRange AllocateRange(uint32 _count)
+			{
+				if (_count == 0)
+				{
+					return EntityRange{};
+				}
+
+				std::ranges::sort(m_freeIndices);
+
+				usize runStart{ 0 };
+				for (usize i = 0; i < m_freeIndices.size(); ++i)
+				{
+					if (i > runStart && m_freeIndices[i] != m_freeIndices[i - 1] + 1)
+					{
+						runStart = i;
+					}
+					if (i + 1 - runStart == _count)
+					{
+						uint32 const first = m_freeIndices[runStart];
+						m_freeIndices.erase(m_freeIndices.begin() + runStart, m_freeIndices.begin() + i + 1);
+						return EntityRange{ Core::detail::AccessECSID(EntityID::Make(first, 0)), _count };
+					}
+				}
+
+				// runStart is now the start of the last run. If it reaches the never-used indices, it can be extended.
+				uint32 numReused{ 0 };
+				if (!m_freeIndices.empty() && m_freeIndices.back() + 1 == m_nextIndex)
+				{
+					numReused = static_cast<uint32>(m_freeIndices.size() - runStart);
+					m_freeIndices.resize(runStart);
+				}
+
+				uint32 const first = m_nextIndex - numReused;
+				kaAssert(first + _count <= EntityID::c_maxIndex, "ran out of entity IDs");
+				g_generations.EnsureRange(m_nextIndex, _count - numReused);
+				m_nextIndex = first + _count;
+				return EntityRange{ Core::detail::AccessECSID(EntityID::Make(first, 0)), _count };
+			}
+
+			uint32 GetUsedIndexCount() const
+			{
+				return m_nextIndex;
+			}
+
+			void FreeID(EntityID _entity)
+			{
+				g_generations.Bump(_entity.GetIndex());
+				m_freeIndices.emplace_back(_entity.GetIndex());
+			}
+
 			bool IsActiveEntity( EntityID _entity ) const
 			{
-				return m_active.contains( _entity );
+				// the set compares generations too, but checking the table first skips the hash for stale handles
+				return g_generations.Get( _entity.GetIndex() ) == _entity.GetGeneration() && m_active.contains( _entity );
+			}
+
+			uint64 GetCreationOrder( EntityID _entity ) const
+			{
+				return m_creationOrder[ GetEntityIndex( _entity ) ];
 			}
 
 			void AddActiveEntity
@@ -57,18 +335,58 @@ namespace Core
 					m_sceneActive.insert( _entity );
 				}
 
+				usize const entityI = GetEntityIndex( _entity );
+				if ( entityI >= m_creationOrder.size() )
+				{
+					m_creationOrder.resize( entityI + 1 );
+				}
+				m_creationOrder[ entityI ] = m_nextCreationOrder++;
+
 #if ENTITY_LOGGING_ENABLED
 				kaLog( std::format( "Entity {:d} was created", _entity.GetDebugValue() ) );
 #endif
 			}
 
+			void AddActiveEntities
+			(
+				EntityRange _entities,
+				bool _persistent
+			)
+			{
+				m_active.reserve( m_active.size() + _entities.Count() );
+				if ( !_persistent )
+				{
+					m_sceneActive.reserve( m_sceneActive.size() + _entities.Count() );
+				}
+
+				// ranges can reuse destroyed indices, so may not reach the end
+				m_creationOrder.resize( std::max( m_creationOrder.size(), GetEntityIndex( _entities.Last() ) + 1 ) );
+
+				for ( uint32 i = 0; i < _entities.Count(); ++i )
+				{
+					m_active.insert( _entities[i] );
+					if ( !_persistent )
+					{
+						m_sceneActive.insert( _entities[i] );
+					}
+					m_creationOrder[ GetEntityIndex( _entities[i] ) ] = m_nextCreationOrder++;
+				}
+
+#if ENTITY_LOGGING_ENABLED
+				kaLog( std::format( "Entities {:d}-{:d} were created", _entities.First().GetDebugValue(), _entities.Last().GetDebugValue() ) );
+#endif
+			}
+
 			void RemoveActiveEntity
 			(
 				EntityID _entity
 			)
 			{
-				m_active.erase( _entity );
-				m_sceneActive.erase( _entity );
+				if ( m_active.erase( _entity ) > 0 )
+				{
+					m_sceneActive.erase( _entity );
+					FreeID( _entity );
+				}
 
 #if ENTITY_LOGGING_ENABLED
 				kaLog( std::format( "Entity {:d} was killed", _entity.GetDebugValue() ) );
@@ -77,6 +395,10 @@ namespace Core
 
 			void RemoveAllActiveEntities()
 			{
+				for ( EntityID const entity : m_active )
+				{
+					FreeID( entity );
+				}
 				m_active.clear();
 				m_sceneActive.clear();
 
@@ -85,6 +407,59 @@ namespace Core
 #endif
 			}
 		};
+
+		struct EntityHierarchy
+		{
+			using Children = absl::InlinedVector<EntityID, 4>;
+
+			// Indexed by the parent's entity index, so the world transform passes can find children without hashing.
+			std::vector<Children> m_children;
+
+			Children const* Find( EntityID _parent ) const
+			{
+				usize const parentI = GetEntityIndex( _parent );
+				return parentI < m_children.size() && !m_children[ parentI ].empty() ? &m_children[ parentI ] : nullptr;
+			}
+
+			void AddChild( EntityID _parent, EntityID _child )
+			{
+				usize const parentI = GetEntityIndex( _parent );
+				if ( parentI >= m_children.size() )
+				{
+					m_children.resize( parentI + 1 );
+				}
+				m_children[ parentI ].emplace_back( _child );
+			}
+
+			void RemoveChild( EntityID _parent, EntityID _child )
+			{
+				usize const parentI = GetEntityIndex( _parent );
+				kaAssert( parentI < m_children.size() && !m_children[ parentI ].empty(), "tried to remove child from entity with no children" );
+				if ( parentI < m_children.size() )
+				{
+					Children& children = m_children[ parentI ];
+					auto childI = std::find( children.begin(), children.end(), _child );
+					kaAssert( childI != children.end(), "tried to remove child from wrong parent" );
+					if ( childI != children.end() )
+					{
+						// order doesn't matter, so swap and pop
+						*childI = children.back();
+						children.pop_back();
+					}
+				}
+			}
+
+			void RemoveAllChildren( EntityID _parent )
+			{
+				usize const parentI = GetEntityIndex( _parent );
+				if ( parentI < m_children.size() )
+				{
+					m_children[ parentI ].clear();
+				}
+			}
+		};
+		static Mutex< EntityHierarchy > g_hierarchy;
+
 		using EntityDataMutex = SharedMutex< EntityData >;
 		using EntityDataWriteGuard = EntityDataMutex::WriteGuard;
 		static EntityDataMutex g_entityData;
@@ -93,12 +468,30 @@ namespace Core
 
 		static ComponentDestroyerBase const* GetDestroyer
 		(
-			ComponentHash _hash
+			ComponentTypeIndex _typeIndex
 		)
 		{
-			auto compDestroyerI = g_destroyers.find(_hash);
-			kaAssert(compDestroyerI != g_destroyers.end(), "tried to destroy a component that is missing a destroyer");
-			return compDestroyerI->second.get();
+			kaAssert(_typeIndex < c_maxComponentTypes && g_destroyers[_typeIndex], "tried to destroy a component that is missing a destroyer");
+			return g_destroyers[_typeIndex].get();
+		}
+
+		ComponentTypeIndex RegisterComponentType
+		(
+			ComponentHash _hash,
+			std::unique_ptr<ComponentDestroyerBase> _destroyer
+		)
+		{
+			auto componentTypesAccess = g_componentTypes.Write();
+			if (auto const existingI = componentTypesAccess->m_indices.find(_hash); existingI != componentTypesAccess->m_indices.end())
+			{
+				return existingI->second;
+			}
+
+			kaAssert(componentTypesAccess->m_count < c_maxComponentTypes, "ran out of component type indices, increase c_maxComponentTypes");
+			ComponentTypeIndex const newIndex = componentTypesAccess->m_count++;
+			g_destroyers[newIndex] = std::move(_destroyer);
+			componentTypesAccess->m_indices.emplace(_hash, newIndex);
+			return newIndex;
 		}
 
 		static bool IsActiveEntity
@@ -109,92 +502,192 @@ namespace Core
 			return g_entityData.Read()->IsActiveEntity( _entity );
 		}
 
-		static std::vector<ComponentChange>::iterator FindComponentChange
+		void AddComponentType
 		(
-			std::vector<ComponentChange>& _compList,
-			ComponentHash _hash
+			EntityID _entity,
+			ComponentTypeIndex _typeIndex
 		)
 		{
-			return std::find_if(_compList.begin(), _compList.end(), [&_hash](auto const& _c) { return _c.m_hash == _hash; });
+			ComponentChangeJournal& journal = GetThreadJournal();
+			absl::MutexLock lock(&journal.m_mutex);
+			journal.m_changes.emplace_back(EntityRange{ Core::detail::AccessECSID(_entity), 1 }, _typeIndex, true);
 		}
 
-		static std::vector<ComponentHash>::iterator FindComponent
+		void RemoveComponentType
 		(
-			std::vector<ComponentHash>& _compList,
-			ComponentHash _hash
+			EntityID _entity,
+			ComponentTypeIndex _typeIndex
 		)
 		{
-			return std::find(_compList.begin(), _compList.end(), _hash);
+			ComponentChangeJournal& journal = GetThreadJournal();
+			absl::MutexLock lock(&journal.m_mutex);
+			journal.m_changes.emplace_back(EntityRange{ Core::detail::AccessECSID(_entity), 1 }, _typeIndex, false);
 		}
 
-		void AddComponentHash
+		void AddComponentTypeToRange
 		(
-			EntityID _entity,
-			ComponentHash _hash
+			EntityRange _entities,
+			ComponentTypeIndex _typeIndex
 		)
 		{
-			kaAssert(IsActiveEntity(_entity), "tried to add components to dead entity!");
-			auto componentChangeAccess = g_componentChangeData.Write();
-			// slow assert
-			kaAssert(FindComponentChange(componentChangeAccess->m_uncommittedChanges[_entity], _hash) == componentChangeAccess->m_uncommittedChanges[_entity].end(), "do not try to add/remove the same component to an entity more than once a frame");
-			componentChangeAccess->m_uncommittedChanges[_entity].emplace_back(_hash, true);
+			ComponentChangeJournal& journal = GetThreadJournal();
+			absl::MutexLock lock(&journal.m_mutex);
+			journal.m_changes.emplace_back(_entities, _typeIndex, true);
 		}
 
-		void RemoveComponentHash
+		// Moves everything in the journals into per-entity pending masks. Returns true if there was anything to merge.
+		// _lockedEntityData is used for debug checks when the caller already holds the entity data lock.
+		static bool MergeJournals
 		(
-			EntityID _entity,
-			ComponentHash _hash
+			ComponentChangeData& io_changeData,
+			EntityData const* _lockedEntityData
 		)
 		{
-			auto componentChangeAccess = g_componentChangeData.Write();
+			thread_local std::vector<ComponentChange> t_scratch;
+
+			bool mergedAny{ false };
+			auto journalsAccess = g_journals.Read();
+			for (std::unique_ptr<ComponentChangeJournal> const& journal : *journalsAccess)
+			{
+				{
+					absl::MutexLock lock(&journal->m_mutex);
+					std::swap(journal->m_changes, t_scratch);
+				}
+
+				for (ComponentChange const& change : t_scratch)
+				{
+					// grow once for the whole range rather than per entity
+					io_changeData.Get(change.m_entities.Last());
+
+					for (uint32 i = 0; i < change.m_entities.Count(); ++i)
+					{
+						EntityID const entity = change.m_entities[i];
+						kaAssert(!change.m_added || (_lockedEntityData != nullptr ? _lockedEntityData->IsActiveEntity(entity) : IsActiveEntity(entity)), "tried to add components to dead entity!");
+
+						EntityComponents& components = io_changeData.Get(entity);
+						kaAssert(!components.m_added.Test(change.m_typeIndex) && !components.m_removed.Test(change.m_typeIndex), "do not try to add/remove the same component to an entity more than once a frame");
+						if (!components.HasUncommittedChanges())
+						{
+							io_changeData.m_changedEntities.emplace_back(entity);
+						}
+						if (change.m_added)
+						{
+							components.m_added.Set(change.m_typeIndex);
+						}
+						else
+						{
+							components.m_removed.Set(change.m_typeIndex);
+						}
+					}
+				}
+
+				mergedAny |= !t_scratch.empty();
+				t_scratch.clear();
+			}
 
-			// slow assert
-			kaAssert(FindComponentChange(componentChangeAccess->m_uncommittedChanges[_entity], _hash) == componentChangeAccess->m_uncommittedChanges[_entity].end(), "do not try to add/remove the same component to an entity more than once a frame");
-			componentChangeAccess->m_uncommittedChanges[_entity].emplace_back(_hash, false);
+			return mergedAny;
 		}
 
-		void CommitChanges()
+		static void CommitChanges
+		(
+			EntityData const* _lockedEntityData
+		)
 		{
 			auto componentChangeAccess = g_componentChangeData.Write();
 
-			for (auto const& [entity, compChangeList] : componentChangeAccess->m_uncommittedChanges)
+			// cleanup may queue up further changes, so keep going until the journals stay empty.
+			while (MergeJournals(*componentChangeAccess, _lockedEntityData))
 			{
-				auto& componentList = componentChangeAccess->m_committed[entity];
-				for (auto const& change : compChangeList)
+				for (EntityID const entity : componentChangeAccess->m_changedEntities)
 				{
-					if (change.m_added)
-					{
-						kaAssert(FindComponent(componentList, change.m_hash) == componentList.end(), "tried to add a component twice");
-						componentList.emplace_back(change.m_hash);
-					}
-					else
+					EntityComponents& components = componentChangeAccess->Get(entity);
+					ComponentMask const removed = components.m_removed;
+
+					kaAssert(!components.m_committed.Intersects(components.m_added), "tried to add a component twice");
+					kaAssert(removed.SubsetOf(components.m_committed), "tried to remove a component twice");
+					components.m_committed |= components.m_added;
+					components.m_committed.RemoveAll(removed);
+					components.m_added.Reset();
+					components.m_removed.Reset();
+
+					removed.ForEach([entity](ComponentTypeIndex _typeIndex)
 					{
-						auto compI = FindComponent(componentList, change.m_hash);
-						kaAssert(compI != componentList.end(), "tried to remove a component twice");
-						GetDestroyer(change.m_hash)->CleanupComponent(entity);
-						componentList.erase(compI);
-					}
+						GetDestroyer(_typeIndex)->CleanupComponent(entity);
+					});
 				}
+				componentChangeAccess->m_changedEntities.clear();
 			}
-			componentChangeAccess->m_uncommittedChanges.clear();
+		}
 
-			for (auto entityI = componentChangeAccess->m_committed.begin(); entityI != componentChangeAccess->m_committed.end();)
+		void CommitChanges()
+		{
+			CommitChanges(nullptr);
+		}
+
+		void ChangeParent
+		(
+			EntityID _child,
+			EntityID _oldParent,
+			EntityID _newParent
+		)
+		{
+			if ( _oldParent == _newParent )
 			{
-				auto entityCopyI = entityI++;
-				if (entityCopyI->second.empty())
-				{
-					componentChangeAccess->m_committed.erase(entityCopyI);
-				}
+				return;
+			}
+
+			auto hierarchyAccess = g_hierarchy.Write();
+			if ( !_oldParent.IsNull() )
+			{
+				hierarchyAccess->RemoveChild( _oldParent, _child );
+			}
+			if ( !_newParent.IsNull() )
+			{
+				hierarchyAccess->AddChild( _newParent, _child );
 			}
 		}
 
-		static void AddActiveEntity
+		absl::InlinedVector<EntityID, 4> GetChildren
 		(
-			EntityID _entity,
+			EntityID _parent
+		)
+		{
+			auto hierarchyAccess = g_hierarchy.Read();
+			EntityHierarchy::Children const* const children = hierarchyAccess->Find( _parent );
+			return children != nullptr ? *children : EntityHierarchy::Children{};
+		}
+
+		std::span<EntityID const> ViewChildrenUnlocked
+		(
+			EntityID _parent
+		)
+		{
+			// Reparenting is only done outside the world transform groups that use this, so there's no writer to lock out.
+			EntityHierarchy::Children const* const children = g_hierarchy.ReadUnlocked().Find( _parent );
+			return children != nullptr ? std::span<EntityID const>{ children->data(), children->size() } : std::span<EntityID const>{};
+		}
+
+		static EntityID CreateActiveEntity
+		(
+			bool _persistent
+		)
+		{
+			auto entityAccess = g_entityData.Write();
+			EntityID const newID = entityAccess->AllocateID();
+			entityAccess->AddActiveEntity( newID, _persistent );
+			return newID;
+		}
+
+		static EntityRange CreateActiveEntities
+		(
+			uint32 _count,
 			bool _persistent
 		)
 		{
-			g_entityData.Write()->AddActiveEntity( _entity, _persistent );
+			auto entityAccess = g_entityData.Write();
+			EntityRange const newIDs = entityAccess->AllocateRange( _count );
+			entityAccess->AddActiveEntities( newIDs, _persistent );
+			return newIDs;
 		}
 
 		static void RemoveActiveEntity
@@ -239,52 +732,90 @@ namespace Core
 			// this function is what all this effort is for.
 			auto componentChangeAccess = g_componentChangeData.Write();
 
+			kaAssert(_entityAccess->IsActiveEntity(_entity), "tried to destroy dead entity!");
+
 			absl::InlinedVector<EntityID, 32> entitiesToDestroy;
 			entitiesToDestroy.emplace_back(_entity);
 			
 			// fill vector until no more children are found
-			for(usize entityToCheckI{ 0 }; entityToCheckI < entitiesToDestroy.size(); ++entityToCheckI)
 			{
-				for (auto const& entity : _entityAccess->m_active)
+				auto hierarchyAccess = g_hierarchy.Read();
+				for (usize entityToCheckI{ 0 }; entityToCheckI < entitiesToDestroy.size(); ++entityToCheckI)
 				{
-					if (auto const transform = Core::GetComponent<Core::Transform3D>(entity); transform && transform->m_parent.IsValid())
+					EntityHierarchy::Children const* const children = hierarchyAccess->Find(entitiesToDestroy[entityToCheckI]);
+					if (children == nullptr)
 					{
-						if (transform->m_parent == entitiesToDestroy[entityToCheckI])
-						{
-							entitiesToDestroy.emplace_back(entity);
-						}
+						continue;
 					}
+
+					entitiesToDestroy.insert(entitiesToDestroy.end(), children->begin(), children->end());
 				}
 			}
 
+			// commit anything added this frame first, so that it gets removed too
+			CommitChanges(&*_entityAccess);
+
 			for (auto entityI = entitiesToDestroy.rbegin(); entityI != entitiesToDestroy.rend(); ++entityI)
 			{
-				kaAssert(_entityAccess->IsActiveEntity(*entityI), "tried to destroy dead entity!");
+				// an entity can be parented by more than one transform type, so may be listed twice
+				if (!_entityAccess->IsActiveEntity(*entityI))
+				{
+					continue;
+				}
 
-				auto commCompI = componentChangeAccess->m_committed.find(*entityI);
-				kaAssert(commCompI != componentChangeAccess->m_committed.end(), "tried to destroy non-existent entity");
+				// cleanup could add components back, so keep going until there's nothing left.
+				// Pointers into the change data aren't kept across commits, as they can resize it.
+				for (EntityComponents const* components = componentChangeAccess->Find(*entityI); components != nullptr && !components->m_committed.None(); components = componentChangeAccess->Find(*entityI))
+				{
+					// copy, as removing modifies the entity's pending state
+					ComponentMask const committed = components->m_committed;
+					committed.ForEachReverse([entity = *entityI](ComponentTypeIndex _typeIndex)
+					{
+						GetDestroyer(_typeIndex)->RemoveComponent(entity);
+					});
+					CommitChanges(&*_entityAccess);
+				}
 
-				for (auto compHashI = commCompI->second.rbegin(); compHashI != commCompI->second.rend(); ++compHashI)
+				// the index is about to be recycled, so the next generation mustn't inherit anything
+				if (EntityComponents* const components = componentChangeAccess->Find(*entityI); components != nullptr)
 				{
-					GetDestroyer(*compHashI)->RemoveComponent(*entityI);
+					*components = EntityComponents{};
 				}
-				CommitChanges();
+
+				// children are destroyed first and unparent themselves, but clear up in case something parented without a transform
+				g_hierarchy.Write()->RemoveAllChildren(*entityI);
 
 				_entityAccess->RemoveActiveEntity(*entityI);
 			}
 		}
 
-		static void DestroyAllEntities()
+		// Newest entities are destroyed first, by creation order rather than ID so that recycled IDs are in the right place. Children go with their parents, so anything already destroyed is skipped.
+		static usize DestroyEntitiesNewestFirst
+		(
+			EntityDataWriteGuard& _entityAccess,
+			absl::flat_hash_set<EntityID> const& _entities
+		)
 		{
-			auto entityAccess = g_entityData.Write();
+			std::vector<EntityID> entitiesToDestroy(_entities.begin(), _entities.end());
+			std::sort(entitiesToDestroy.begin(), entitiesToDestroy.end(), [&entityData = *_entityAccess](EntityID _a, EntityID _b) { return entityData.GetCreationOrder(_b) < entityData.GetCreationOrder(_a); });
 
-			while (!entityAccess->m_active.empty())
+			for (EntityID const entity : entitiesToDestroy)
 			{
-				auto maxI = std::max_element(entityAccess->m_active.begin(), entityAccess->m_active.end());
-
-				DestroyEntityAndComponents(entityAccess, *maxI);
+				if (_entityAccess->IsActiveEntity(entity))
+				{
+					DestroyEntityAndComponents(_entityAccess, entity);
+				}
 			}
 
+			return entitiesToDestroy.size();
+		}
+
+		static void DestroyAllEntities()
+		{
+			auto entityAccess = g_entityData.Write();
+
+			DestroyEntitiesNewestFirst(entityAccess, entityAccess->m_active);
+
 			entityAccess->RemoveAllActiveEntities();
 		}
 
@@ -292,12 +823,15 @@ namespace Core
 		{
 			auto entityAccess = g_entityData.Write();
 
-			while (!entityAccess->m_sceneActive.empty())
-			{
-				auto maxI = std::max_element(entityAccess->m_sceneActive.begin(), entityAccess->m_sceneActive.end());
+#if DEBUG_TOOLS
+			uint64 const startTicks = stm_now();
+#endif
+			[[maybe_unused]] usize const numDestroyed = DestroyEntitiesNewestFirst(entityAccess, entityAccess->m_sceneActive);
+			kaAssert(entityAccess->m_sceneActive.empty());
 
-				DestroyEntityAndComponents(entityAccess, *maxI);
-			}
+#if DEBUG_TOOLS
+			kaLog(std::format("Destroyed {:d} scene entities in {:.3f}ms", numDestroyed, stm_ms(stm_since(startTicks))));
+#endif
 		}
 
 		void TransitionScene
@@ -316,20 +850,47 @@ namespace Core
 		}
 	}
 
-	static EntityID::CoreType g_nextID = 0;
+	namespace detail
+	{
+		bool IsCurrentGeneration
+		(
+			EntityID _entity
+		)
+		{
+			return EntityManagement::g_generations.Get(_entity.GetIndex()) == _entity.GetGeneration();
+		}
+
+		uint32 GetCurrentGeneration
+		(
+			uint32 _index
+		)
+		{
+			return EntityManagement::g_generations.Get(_index);
+		}
+	}
 
 	EntityID CreateEntity()
 	{
-		EntityID newID{ g_nextID++ };
-		EntityManagement::AddActiveEntity(newID, false);
-		return newID;
+		return EntityManagement::CreateActiveEntity(false);
 	}
 
 	EntityID CreatePersistentEntity()
 	{
-		EntityID newID{ g_nextID++ };
-		EntityManagement::AddActiveEntity(newID, true);
-		return newID;
+		return EntityManagement::CreateActiveEntity(true);
+	}
+
+	EntityRange CreateEntities
+	(
+		uint32 _count
+	)
+	{
+		kaAssert(_count > 0, "tried to create an empty range of entities");
+		return EntityManagement::CreateActiveEntities(_count, false);
+	}
+
+	uint32 GetUsedEntityIndexCount()
+	{
+		return EntityManagement::g_entityData.Read()->GetUsedIndexCount();
 	}
 
 	void DestroyEntity
@@ -9,9 +9,11 @@
 #include "scenes/Scene.h"
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/inlined_vector.h>
 
 #include <format>
 #include <memory>
+#include <span>
 #include <type_traits>
 
 #define ENTITY_LOGGING_ENABLED 0
@@ -24,12 +26,37 @@ namespace Core
 		concept ValidComponent = !requires{ typename std::remove_cvref_t<T>::_not_a_component; };
 		template<typename T>
 		concept DoesNotNeedInitialiser = ValidComponent<T> && !requires{ typename std::remove_cvref_t<T>::_initialiser_only; };
+		template<typename T>
+		concept HasCustomAddComponent = requires{ typename std::remove_cvref_t<T>::_custom_add_component; };
 
 		ecs::runtime& GetEcsRuntime();
 	}
 
+	// Contiguous block of entity IDs, as made by CreateEntities.
+	class EntityRange
+	{
+		EntityID::CoreType m_first{};
+		uint32 m_count{ 0 };
+
+	public:
+		EntityRange() = default;
+		EntityRange(EntityID::CoreType _first, uint32 _count) : m_first{ _first }, m_count{ _count } {}
+
+		uint32 Count() const { return m_count; }
+		EntityID First() const { return EntityID{ m_first }; }
+		EntityID Last() const { return (*this)[m_count - 1]; }
+		EntityID operator[](uint32 _index) const
+		{
+			kaAssert(_index < m_count);
+			return EntityID{ EntityID::CoreType{ static_cast<EntityID::CoreType::value>(static_cast<EntityID::CoreType::value>(m_first) + _index) } };
+		}
+	};
+
 	EntityID CreateEntity();
 	EntityID CreatePersistentEntity();
+	EntityRange CreateEntities(uint32 _count);
+	// How many entity indices have ever been handed out. Destroyed entities' indices are reused, so this follows the most alive at once.
+	uint32 GetUsedEntityIndexCount();
 	void DestroyEntity(EntityID _entity);
 	void DestroyAllEntities();
 	void ChangeEntityPersistence(EntityID _entity, bool _keepBetweenScenes);
@@ -69,37 +96,46 @@ namespace Core
 		template<detail::ValidComponent T_Component>
 		constexpr ComponentHash GetComponentHash() { return ecs::detail::get_type_hash<T_Component>(); }
 
-		extern absl::flat_hash_map<ComponentHash, std::unique_ptr<ComponentDestroyerBase>> g_destroyers;
+		// Each component type gets a small dense index the first time it's seen, so per-entity component sets can be bitsets instead of hash lists.
+		using ComponentTypeIndex = uint16;
+		inline constexpr usize c_maxComponentTypes = 128;
+
+		ComponentTypeIndex RegisterComponentType(ComponentHash _hash, std::unique_ptr<ComponentDestroyerBase> _destroyer);
 
 		template<detail::ValidComponent T_Component>
-		void EnsureDestroyer(ComponentHash _hash)
+		ComponentTypeIndex EnsureDestroyer()
 		{
-			auto it = g_destroyers.find(_hash);
-			if (it == g_destroyers.end())
-			{
-				g_destroyers[_hash] = std::unique_ptr<ComponentDestroyerBase>(new ComponentDestroyer<T_Component>());
-			}
+			// static init is thread-safe and means we only pay for registration once per type
+			static ComponentTypeIndex const s_typeIndex = RegisterComponentType(GetComponentHash<T_Component>(), std::make_unique<ComponentDestroyer<T_Component>>());
+			return s_typeIndex;
 		}
 		
-		void AddComponentHash(EntityID _entity, ComponentHash _hash);
-		void RemoveComponentHash(EntityID _entity, ComponentHash _hash);
+		void AddComponentType(EntityID _entity, ComponentTypeIndex _typeIndex);
+		void RemoveComponentType(EntityID _entity, ComponentTypeIndex _typeIndex);
+		void AddComponentTypeToRange(EntityRange _entities, ComponentTypeIndex _typeIndex);
 
 		template<detail::ValidComponent T_Component>
 		void ComponentAdded(EntityID _entity)
 		{
-			ComponentHash const hash = GetComponentHash<T_Component>();
-			EnsureDestroyer<T_Component>(hash);
-			AddComponentHash(_entity, hash);
+			AddComponentType(_entity, EnsureDestroyer<T_Component>());
 
 #if ENTITY_LOGGING_ENABLED
 			kaLog(std::format("Entity {:d} requested component {:s} to be added", _entity.GetDebugValue(), typeid(T_Component).name()));
+#endif
+		}
+		template<detail::ValidComponent T_Component>
+		void ComponentAddedToRange(EntityRange _entities)
+		{
+			AddComponentTypeToRange(_entities, EnsureDestroyer<T_Component>());
+
+#if ENTITY_LOGGING_ENABLED
+			kaLog(std::format("Entities {:d}-{:d} requested component {:s} to be added", _entities.First().GetDebugValue(), _entities.Last().GetDebugValue(), typeid(T_Component).name()));
 #endif
 		}
 		template<detail::ValidComponent T_Component>
 		void ComponentRemoved(EntityID _entity)
 		{
-			ComponentHash const hash = GetComponentHash<T_Component>();
-			RemoveComponentHash(_entity, hash);
+			RemoveComponentType(_entity, EnsureDestroyer<T_Component>());
 
 #if ENTITY_LOGGING_ENABLED
 			kaLog(std::format("Entity {:d} requested component {:s} to be removed", _entity.GetDebugValue(), typeid(T_Component).name()));
@@ -107,6 +143,12 @@ namespace Core
 		}
 		void CommitChanges();
 
+		// Parent->children index. Kept in sync by components that parent entities (i.e. transforms), so that destroying an entity can find its children without searching every entity.
+		void ChangeParent(EntityID _child, EntityID _oldParent, EntityID _newParent);
+		absl::InlinedVector<EntityID, 4> GetChildren(EntityID _parent);
+		// No lock or copy, for the world transform passes. Only valid while nothing can reparent, and until the next reparent.
+		std::span<EntityID const> ViewChildrenUnlocked(EntityID _parent);
+
 		void TransitionScene(std::shared_ptr<Core::Scene::BaseScene> const& _nextScene);
 	}
 
@@ -122,6 +164,14 @@ namespace Core
 			detail::GetEcsRuntime().add_component(Core::detail::AccessECSID(_entity), static_cast<std::remove_const_t<T_Component>>(_component));
 		}
 
+		// Wraps ecs::add_component with an entity range, shouldn't be used directly except by specialisations of AddComponentToRange
+		template <detail::ValidComponent T_Component>
+		void AddComponentToRange(EntityRange const _entities, T_Component const& _component)
+		{
+			EntityManagement::ComponentAddedToRange<T_Component>(_entities);
+			detail::GetEcsRuntime().add_component(ecs::entity_range{ Core::detail::AccessECSID(_entities.First()), Core::detail::AccessECSID(_entities.Last()) }, static_cast<std::remove_const_t<T_Component>>(_component));
+		}
+
 		// Wraps ecs::remove_component, shouldn't be used directly.
 		template<detail::ValidComponent T_Component>
 		void RemoveComponent(EntityID const _entity)
@@ -159,6 +209,35 @@ namespace Core
 		(AddComponent(_entity, _components), ...);
 	}
 
+	// Basic AddComponentToRange, used by CreateEntities to give every entity in the range a copy of the component in one go.
+	// Components with an AddComponent specialisation must be marked custom_add_component, so that they go through it for each entity instead.
+	// They can also specialise this (or delete it) if there's something better to do for a whole range.
+	template<detail::DoesNotNeedInitialiser T_Component>
+	void AddComponentToRange(EntityRange const _entities, T_Component const& _component)
+	{
+		if constexpr (detail::HasCustomAddComponent<T_Component>)
+		{
+			for (uint32 i = 0; i < _entities.Count(); ++i)
+			{
+				AddComponent(_entities[i], _component);
+			}
+		}
+		else
+		{
+			ECS::AddComponentToRange(_entities, _component);
+		}
+	}
+
+	// Bulk version of CreateEntity + AddComponents, for spawning many similar entities at once.
+	template<detail::DoesNotNeedInitialiser T_FirstComponent, detail::DoesNotNeedInitialiser... T_Components>
+	EntityRange CreateEntities(uint32 const _count, T_FirstComponent const& _firstComponent, T_Components const&... _components)
+	{
+		EntityRange const entities = CreateEntities(_count);
+		AddComponentToRange(entities, _firstComponent);
+		(AddComponentToRange(entities, _components), ...);
+		return entities;
+	}
+
 	// Basic CleanupComponent. This allows for specialisation for components that want to destroy things
 	// pre-condition: entity has the component.
 	template<detail::ValidComponent T_Component>
@@ -4,6 +4,7 @@
 
 #include "common/Mutex.h"
 #include "common/StaticVector.h"
+#include "common/TransformBatch.h"
 #include "systems.h"
 #include "components.h"
 #include "shaders/main.h"
@@ -18,9 +19,14 @@
 
 #include <sokol_app.h>
 #include <sokol_gfx.h>
+#if !DRIFT_HEADLESS
 #include <sokol_glue.h>
+#endif
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <optional>
 
 // classes
 namespace Core
@@ -71,6 +77,10 @@ namespace Core
 			e_PassGlue m_currentPassGlue{ e_PassGlue_Count };
 			e_Renderer m_currentRenderer{ e_Renderer_Count };
 			int m_storedBindingNumToDraw{ 0 };
+			bool m_storedBindingIndexed{ false };
+
+			FrameStats m_stats{};
+			FrameStats m_lastFrameStats{}; // copied at Commit, so readers always see a whole frame
 
 			std::array<std::optional<Pass>, e_Pass_Count> m_passes{};
 			std::array<std::optional<PassGlue>, e_PassGlue_Count> m_passGlues{};
@@ -95,6 +105,7 @@ namespace Core
 
 				kaAssert(_pass < e_Pass_Count);
 
+				++m_stats.m_passSwitches;
 				if (_pass == e_DefaultPass)
 				{
 					sg_begin_default_pass(m_defaultPassAction, sapp_width(), sapp_height());
@@ -126,6 +137,7 @@ namespace Core
 				if (m_passGlues[_passGlue]->Set(m_currentPass, m_currentRenderer))
 				{
 					m_currentPassGlue = _passGlue;
+					++m_stats.m_bindingsApplied;
 				}
 				else
 				{
@@ -145,6 +157,22 @@ namespace Core
 				sg_apply_bindings(_binds);
 				m_currentPassGlue = e_PassGlue_Count;
 				m_storedBindingNumToDraw = _numToDraw;
+				m_storedBindingIndexed = _binds.index_buffer.id != SG_INVALID_ID;
+				++m_stats.m_bindingsApplied;
+			}
+
+			void ApplyUniforms(sg_shader_stage _stage, int _slot, sg_range const& _data)
+			{
+				kaAssert(m_currentRenderer < e_Renderer_Count);
+
+				sg_apply_uniforms(_stage, _slot, _data);
+				++m_stats.m_uniformApplies;
+			}
+
+			void UpdateBuffer(sg_buffer _buffer, sg_range const& _data)
+			{
+				sg_update_buffer(_buffer, _data);
+				m_stats.m_bytesUploaded += _data.size;
 			}
 
 			void SetRenderer(e_Renderer _renderer)
@@ -165,13 +193,17 @@ namespace Core
 				kaAssert(m_currentRenderer == _renderer);
 			}
 
-			void Draw(int numElements, int baseElement, int numInstances)
+			void Draw(int numElements, int baseElement, int numInstances, bool _indexed)
 			{
 				kaAssert(m_currentPass < e_Pass_Count);
 				kaAssert(m_currentRenderer < e_Renderer_Count);
 				kaAssert(numElements > 0);
 
 				sg_draw(baseElement, numElements, numInstances);
+
+				++m_stats.m_drawCalls;
+				usize& elementsSubmitted = _indexed ? m_stats.m_indicesSubmitted : m_stats.m_verticesSubmitted;
+				elementsSubmitted += static_cast<usize>(numElements) * static_cast<usize>(numInstances);
 			}
 
 			void Draw(int numInstances = 1)
@@ -180,14 +212,18 @@ namespace Core
 
 				if (m_currentPassGlue < e_PassGlue_Count)
 				{
-					Draw(m_passGlues[m_currentPassGlue]->NumToDraw(), s_baseElement, numInstances);
+					Draw(m_passGlues[m_currentPassGlue]->NumToDraw(), s_baseElement, numInstances, m_passGlues[m_currentPassGlue]->IsIndexed());
 				}
 				else
 				{
-					Draw(m_storedBindingNumToDraw, s_baseElement, numInstances);
+					Draw(m_storedBindingNumToDraw, s_baseElement, numInstances, m_storedBindingIndexed);
 				}
 			}
 
+			FrameStats& Stats() { return m_stats; }
+			FrameStats const& LastFrameStats() const { return m_lastFrameStats; }
+			void ResetStats() { m_stats = {}; }
+
 			void MainCameraSet() { m_mainCameraIsSet = true; }
 			bool IsMainCameraSet() const { return m_mainCameraIsSet; }
 
@@ -198,6 +234,7 @@ namespace Core
 					sg_end_pass();
 				}
 				sg_commit();
+				m_lastFrameStats = m_stats;
 				m_currentPass = e_Pass_Count;
 				m_currentPassGlue = e_PassGlue_Count;
 				m_currentRenderer = e_Renderer_Count;
@@ -247,24 +284,99 @@ namespace Core
 			{}
 		};
 
+		// Per instance vertex data for models, streamed each frame and shared by the shadow and main passes.
+		struct ModelInstanceData
+		{
+			Mat4 m_viewModel;
+			Mat3 m_normal;
+		};
+		static_assert(offsetof(ModelInstanceData, m_normal) == sizeof(Vec4) * 4, "instance attribute offsets are worked out by sokol from the formats"); // any tail padding is covered by the stride
+
+		static constexpr usize c_maxModelInstances = 16'384; // per pass
+
+		// A run of instances of the same model in the instance buffer, drawn with one sg_draw per mesh.
+		struct ModelBatch
+		{
+			Resource::ModelData const* m_model{ nullptr };
+			int m_firstInstance{ 0 };
+			int m_numInstances{ 0 };
+		};
+
+		// One array per value, indexed by queued model, so each can be filled for every model in one batch.
 		struct ModelScratchData
 		{
-			Resource::ModelData const& m_model;
-			Mat4 const m_renderMatrix;
+			std::vector<Resource::ModelData const*> m_models;
+			std::vector<Mat4> m_renderMatrices;
+			std::vector<Vec4> m_localSpheres;
+			std::vector<Vec4> m_worldSpheres;
+			std::vector<uint8> m_shadowVisible;
+			std::vector<uint8> m_mainVisible;
+			std::vector<Mat4> m_viewModelMatrices;
+			std::vector<Mat4> m_normalMatrices;
+
+			// instances that survived culling, the shadow pass's followed by the main pass's
+			std::vector<ModelInstanceData> m_instances;
+			std::vector<ModelBatch> m_shadowBatches;
+			std::vector<ModelBatch> m_mainBatches;
+
+			void Resize(usize _count)
+			{
+				m_models.resize(_count);
+				m_renderMatrices.resize(_count);
+				m_localSpheres.resize(_count);
+				m_worldSpheres.resize(_count);
+				m_shadowVisible.resize(_count);
+				m_mainVisible.resize(_count);
+				m_viewModelMatrices.resize(_count);
+				m_normalMatrices.resize(_count);
+				m_instances.clear();
+				m_shadowBatches.clear();
+				m_mainBatches.clear();
+			}
 
-			ModelScratchData(Resource::ModelData const& _model, Mat4 const& _renderMatrix)
-				: m_model{ _model }
-				, m_renderMatrix{ _renderMatrix }
-			{}
+			usize Count() const { return m_models.size(); }
+		};
+
+		struct LightToDraw
+		{
+			Vec4 m_col{};
+			Vec4 m_pos{};
+			Vec4 m_att{};
+			Vec4 m_dir{};
+			Vec4 m_cut{};
+		};
+
+		// Per-thread list of everything queued to draw this frame, so RENDER_QUEUE systems running in parallel don't serialise on each other.
+		// Only touched by its own thread until Render gathers them all up, which runs after every RENDER_QUEUE system has finished, so there's no lock.
+		struct RenderQueue
+		{
+			std::vector<ModelToDraw> m_models;
+			std::vector<LightToDraw> m_lights;
+			Vec3 m_ambientLight{};
+			std::optional<Vec3> m_directionalDir;
 		};
 
+		// Queues are owned here rather than by the thread so that they survive worker threads shutting down.
+		static Mutex< std::vector<std::unique_ptr<RenderQueue>> > g_renderQueues;
+
+		static RenderQueue& GetThreadRenderQueue()
+		{
+			thread_local RenderQueue* t_queue{ nullptr };
+			if (t_queue == nullptr)
+			{
+				t_queue = g_renderQueues.Write()->emplace_back(std::make_unique<RenderQueue>()).get();
+			}
+			return *t_queue;
+		}
+
 		struct FrameScene
 		{
-			Mutex< LightsState > lights{};
+			LightsState lights{}; // gathered from the render queues
 			Resource::TextureSampleID directionalShadowMap{};
 			CameraState camera{};
-			Mutex< std::vector<ModelToDraw> > models;
-			std::vector<ModelScratchData> modelScratchData;
+			std::vector<ModelToDraw> models; // gathered from the render queues
+			ModelScratchData modelScratchData;
+			sg_buffer modelInstanceBuffer{};
 
 			SpriteSceneData sceneSpriteData;
 
@@ -287,7 +399,14 @@ namespace Core
 		void Init()
 		{
 			sg_desc gfxDesc{};
+#if DRIFT_HEADLESS
+			// sokol_glue reads every backend's handles from sokol_app, which HeadlessApp.cpp doesn't stub. The dummy backend only needs the formats.
+			gfxDesc.context.color_format = static_cast<sg_pixel_format>(sapp_color_format());
+			gfxDesc.context.depth_format = static_cast<sg_pixel_format>(sapp_depth_format());
+			gfxDesc.context.sample_count = sapp_sample_count();
+#else
 			gfxDesc.context = sapp_sgcontext();
+#endif
 			gfxDesc.buffer_pool_size = 512; // buff it up? // could go muuuuuch higher
 			sg_setup(&gfxDesc);
 		}
@@ -401,6 +520,28 @@ namespace Core
 				g_frameScene.sceneSpriteBuffer = sg_make_buffer( spriteBufferDesc );
 				g_frameScene.sceneSpriteBinds.vertex_buffers[ 1 ] = g_frameScene.sceneSpriteBuffer;
 			}
+
+			{
+				sg_buffer_desc modelInstanceBufferDesc{
+					.size = sizeof( ModelInstanceData ) * c_maxModelInstances * 2, // shadow and main passes
+					.type = SG_BUFFERTYPE_VERTEXBUFFER,
+					.usage = SG_USAGE_STREAM,
+					.label = "model-instance-buffer",
+				};
+				g_frameScene.modelInstanceBuffer = sg_make_buffer( modelInstanceBufferDesc );
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		// Which backend's shader descs to make shaders from.
+		static sg_backend GetShaderBackend()
+		{
+#if defined(SOKOL_DUMMY_BACKEND)
+			// Shaders aren't generated for the dummy backend, but it ignores the source, so any desc with the right layout will do.
+			return SG_BACKEND_GLCORE33;
+#else
+			return sg_query_backend();
+#endif
 		}
 
 		//--------------------------------------------------------------------------------
@@ -424,17 +565,37 @@ namespace Core
 					.format = SG_VERTEXFORMAT_FLOAT3,
 				};
 				mainLayoutDesc.attrs[ATTR_main_vs_aNormal] = {
-					.format = SG_VERTEXFORMAT_FLOAT3,
+					.format = SG_VERTEXFORMAT_SHORT2N,
 				};
 				mainLayoutDesc.attrs[ATTR_main_vs_aTexCoord] = {
 					.format = SG_VERTEXFORMAT_FLOAT2,
 				};
 				mainLayoutDesc.attrs[ATTR_main_vs_aTangent] = {
-					.format = SG_VERTEXFORMAT_FLOAT3,
+					.format = SG_VERTEXFORMAT_SHORT2N,
+				};
+
+				for (int const attr : { ATTR_main_vs_aViewModel0, ATTR_main_vs_aViewModel1, ATTR_main_vs_aViewModel2, ATTR_main_vs_aViewModel3 })
+				{
+					mainLayoutDesc.attrs[attr] = {
+						.buffer_index = 1,
+						.format = SG_VERTEXFORMAT_FLOAT4,
+					};
+				}
+				for (int const attr : { ATTR_main_vs_aNormalMatrix0, ATTR_main_vs_aNormalMatrix1, ATTR_main_vs_aNormalMatrix2 })
+				{
+					mainLayoutDesc.attrs[attr] = {
+						.buffer_index = 1,
+						.format = SG_VERTEXFORMAT_FLOAT3,
+					};
+				}
+				mainLayoutDesc.buffers[0].stride = sizeof(Resource::PackedVertexData);
+				mainLayoutDesc.buffers[1] = {
+					.stride = sizeof(ModelInstanceData),
+					.step_func = SG_VERTEXSTEP_PER_INSTANCE,
 				};
 
 				sg_pipeline_desc mainPipeDesc{
-					.shader = sg_make_shader(main_sg_shader_desc(sg_query_backend())),
+					.shader = sg_make_shader(main_sg_shader_desc(GetShaderBackend())),
 					.layout = mainLayoutDesc,
 					.depth = {
 						.compare = SG_COMPAREFUNC_LESS_EQUAL,
@@ -448,6 +609,13 @@ namespace Core
 				io_state.Renderer(Renderer_Main) = Renderer{ sg_make_pipeline(mainPipeDesc) };
 				io_state.Renderer(Renderer_Main)->AllowGeneralBindings();
 				io_state.Renderer(Renderer_Main)->AddValidPass(Pass_MainTarget);
+
+				// index type is part of the pipeline, so models with 16-bit indices need their own. The shader is shared.
+				mainPipeDesc.index_type = SG_INDEXTYPE_UINT16;
+				mainPipeDesc.label = "main-pipeline-index16";
+				io_state.Renderer(Renderer_Main_Index16) = Renderer{ sg_make_pipeline(mainPipeDesc) };
+				io_state.Renderer(Renderer_Main_Index16)->AllowGeneralBindings();
+				io_state.Renderer(Renderer_Main_Index16)->AddValidPass(Pass_MainTarget);
 			}
 
 			// target to screen renderer, all it does is put a texture on the screen
@@ -461,7 +629,7 @@ namespace Core
 				};
 
 				sg_pipeline_desc targetToScreenDesc{
-					.shader = sg_make_shader(render_target_to_screen_sg_shader_desc(sg_query_backend())),
+					.shader = sg_make_shader(render_target_to_screen_sg_shader_desc(GetShaderBackend())),
 					.layout = targetToScreenLayoutDesc,
 					.depth = {
 						.compare = SG_COMPAREFUNC_LESS,
@@ -483,10 +651,23 @@ namespace Core
 				depthOnlyLayoutDesc.attrs[ATTR_depth_only_vs_aPos] = {
 					.format = SG_VERTEXFORMAT_FLOAT3,
 				};
-				depthOnlyLayoutDesc.buffers[0].stride = sizeof(Resource::VertexData);
+
+				// the normal matrix at the end of each instance is skipped by the stride
+				for (int const attr : { ATTR_depth_only_vs_aViewModel0, ATTR_depth_only_vs_aViewModel1, ATTR_depth_only_vs_aViewModel2, ATTR_depth_only_vs_aViewModel3 })
+				{
+					depthOnlyLayoutDesc.attrs[attr] = {
+						.buffer_index = 1,
+						.format = SG_VERTEXFORMAT_FLOAT4,
+					};
+				}
+				depthOnlyLayoutDesc.buffers[0].stride = sizeof(Resource::PackedVertexData);
+				depthOnlyLayoutDesc.buffers[1] = {
+					.stride = sizeof(ModelInstanceData),
+					.step_func = SG_VERTEXSTEP_PER_INSTANCE,
+				};
 
 				sg_pipeline_desc depthOnlyDesc{
-					.shader = sg_make_shader(depth_only_sg_shader_desc(sg_query_backend())),
+					.shader = sg_make_shader(depth_only_sg_shader_desc(GetShaderBackend())),
 					.layout = depthOnlyLayoutDesc,
 					.depth = {
 						.pixel_format = SG_PIXELFORMAT_DEPTH_STENCIL,
@@ -502,6 +683,12 @@ namespace Core
 				io_state.Renderer(Renderer_DepthOnly) = Renderer{ sg_make_pipeline(depthOnlyDesc) };
 				io_state.Renderer(Renderer_DepthOnly)->AllowGeneralBindings();
 				io_state.Renderer(Renderer_DepthOnly)->AddValidPass(Pass_DirectionalLight);
+
+				depthOnlyDesc.index_type = SG_INDEXTYPE_UINT16;
+				depthOnlyDesc.label = "depth-only-pipeline-index16";
+				io_state.Renderer(Renderer_DepthOnly_Index16) = Renderer{ sg_make_pipeline(depthOnlyDesc) };
+				io_state.Renderer(Renderer_DepthOnly_Index16)->AllowGeneralBindings();
+				io_state.Renderer(Renderer_DepthOnly_Index16)->AddValidPass(Pass_DirectionalLight);
 			}
 
 			// skybox renderer
@@ -512,7 +699,7 @@ namespace Core
 				};
 
 				sg_pipeline_desc skyboxDesc{
-					.shader = sg_make_shader(skybox_sg_shader_desc(sg_query_backend())),
+					.shader = sg_make_shader(skybox_sg_shader_desc(GetShaderBackend())),
 					.layout = skyboxLayoutDesc,
 					.depth = {
 						.compare = SG_COMPAREFUNC_LESS_EQUAL,
@@ -575,7 +762,7 @@ namespace Core
 				static_assert(sizeof(Vec3) + sizeof(Vec2) + sizeof(Vec1) + sizeof(Vec2) + sizeof(Vec2) + sizeof(Vec2) + sizeof(uint32) == sizeof(SpriteBufferData) );
 
 				sg_pipeline_desc spritesDesc{
-					.shader = sg_make_shader(sprites_sg_shader_desc(sg_query_backend())),
+					.shader = sg_make_shader(sprites_sg_shader_desc(GetShaderBackend())),
 					.layout = spritesLayoutDesc,
 					.depth = {
 						.compare = SG_COMPAREFUNC_LESS,
@@ -632,21 +819,84 @@ namespace Core
 		}
 
 		//--------------------------------------------------------------------------------
-		template<typename T_ModelVisitor, typename T_MeshVisitor>
-		void RenderMainScene(T_ModelVisitor const& _fnModelVisitor, T_MeshVisitor const& _fnMeshVisitor)
+		// The index type is baked into a pipeline, so batches are drawn in two runs, one per index type.
+		// _fnRendererSetup is called after each renderer is set, to apply anything shared by all models.
+		// _fnMeshVisitor binds each mesh of a batch, then every instance in the batch is drawn at once.
+		template<typename T_RendererSetup, typename T_MeshVisitor>
+		void RenderMainScene
+		(
+			std::vector<ModelBatch> const& _batches,
+			e_Renderer _renderer32,
+			e_Renderer _renderer16,
+			T_RendererSetup const& _fnRendererSetup,
+			T_MeshVisitor const& _fnMeshVisitor
+		)
 		{
-			for (ModelScratchData const& mtd : g_frameScene.modelScratchData)
+			for (auto const [renderer, indexType] : { std::pair{ _renderer32, SG_INDEXTYPE_UINT32 }, std::pair{ _renderer16, SG_INDEXTYPE_UINT16 } })
 			{
-				_fnModelVisitor(mtd.m_renderMatrix, mtd.m_model);
-
-				for (Resource::MeshData const& mesh : mtd.m_model.m_meshes)
+				bool rendererSet{ false };
+				for (ModelBatch const& batch : _batches)
 				{
-					_fnMeshVisitor(mesh);
+					if (batch.m_model->m_indexType != indexType)
+					{
+						continue;
+					}
 
-					g_renderState.Draw();
+					if (!rendererSet)
+					{
+						g_renderState.SetRenderer(renderer);
+						_fnRendererSetup();
+						rendererSet = true;
+					}
+
+					for (Resource::MeshData const& mesh : batch.m_model->m_meshes)
+					{
+						_fnMeshVisitor(batch, mesh);
+
+						g_renderState.Draw(batch.m_numInstances);
+					}
+				}
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void BindModelInstances
+		(
+			ModelBatch const& _batch,
+			sg_bindings& io_binds
+		)
+		{
+			io_binds.vertex_buffers[1] = g_frameScene.modelInstanceBuffer;
+			io_binds.vertex_buffer_offsets[1] = _batch.m_firstInstance * static_cast<int>(sizeof(ModelInstanceData));
+		}
+
+		//--------------------------------------------------------------------------------
+		// Appends the instances a pass can see to the instance data, batched by model. Returns how many meshes the pass will draw.
+		static usize BatchVisibleInstances
+		(
+			std::vector<uint8> const& _visible,
+			ModelScratchData& io_scratch,
+			std::vector<ModelBatch>& o_batches
+		)
+		{
+			usize numMeshes{ 0 };
+			for (usize modelI = 0; modelI < io_scratch.Count(); ++modelI)
+			{
+				if (_visible[modelI] == 0)
+				{
+					continue;
 				}
 
+				Resource::ModelData const* const model = io_scratch.m_models[modelI];
+				if (o_batches.empty() || o_batches.back().m_model != model)
+				{
+					o_batches.push_back({ model, static_cast<int>(io_scratch.m_instances.size()), 0 });
+				}
+				++o_batches.back().m_numInstances;
+				io_scratch.m_instances.push_back({ io_scratch.m_viewModelMatrices[modelI], Mat3(io_scratch.m_normalMatrices[modelI]) });
+				numMeshes += model->m_meshes.size();
 			}
+			return numMeshes;
 		}
 
 		//--------------------------------------------------------------------------------
@@ -684,81 +934,108 @@ namespace Core
 		(
 		)
 		{
-			auto modelsAccess = g_frameScene.models.Read();
-			auto lightsAccess = g_frameScene.lights.Read();
+			Core::Profiling::Scope const profileScope{ "Render3D" };
+			std::vector<ModelToDraw>& models = g_frameScene.models;
+			LightsState const& lights = g_frameScene.lights;
+			if ( models.size() > c_maxModelInstances )
+			{
+				kaError( "ran out of model instances" );
+				models.resize( c_maxModelInstances );
+			}
+
+			// Copies of the same model end up next to each other, so each run can be drawn as one batch.
+			std::sort( models.begin(), models.end(), []( ModelToDraw const& _a, ModelToDraw const& _b ) { return _a.m_model < _b.m_model; } );
+
+			ModelScratchData& scratch = g_frameScene.modelScratchData;
+			scratch.Resize( models.size() );
+			for ( usize modelI = 0; modelI < models.size(); ++modelI )
+			{
+				ModelToDraw const& mtd = models[ modelI ];
+				scratch.m_models[ modelI ] = &Resource::GetModel( mtd.m_model );
+				scratch.m_renderMatrices[ modelI ] = mtd.m_transform.GetRenderMatrix();
+				scratch.m_localSpheres[ modelI ] = scratch.m_models[ modelI ]->m_boundingSphere;
+				g_renderState.Stats().m_submittedMeshes += scratch.m_models[ modelI ]->m_meshes.size();
+			}
+
+			Mat4 const lightProj = GetDirectionalLightOrthoMat( 10.0f, 1.0f, 50.0f );
+			Vec3 const lightPos = g_frameScene.camera.pos - ( lights.directionalDir * 25.0f );
+			Mat4 const lightView = glm::lookAt( lightPos, lightPos + lights.directionalDir, Vec3( 0.0f, 1.0f, 0.0f ) );
+			Mat4 const lightSpace = lightProj * lightView;
 
-			g_frameScene.modelScratchData.clear();
-			g_frameScene.modelScratchData.reserve( modelsAccess->size() );
-			for ( ModelToDraw const& mtd : *modelsAccess )
+			// Cull against the camera frustum and the shadow volume, then keep only what each pass can see.
+			TransformBatch::TransformSpheres( scratch.m_renderMatrices.data(), scratch.m_localSpheres.data(), scratch.Count(), scratch.m_worldSpheres.data() );
+			TransformBatch::CullSpheres( TransformBatch::GetFrustumPlanes( g_frameScene.camera.proj * g_frameScene.camera.view ), scratch.m_worldSpheres.data(), scratch.Count(), scratch.m_mainVisible.data() );
+			if constexpr ( g_enableDirectionalShadow )
 			{
-				g_frameScene.modelScratchData.emplace_back( Resource::GetModel( mtd.m_model ), mtd.m_transform.GetRenderMatrix() );
+				TransformBatch::CullSpheres( TransformBatch::GetFrustumPlanes( lightSpace ), scratch.m_worldSpheres.data(), scratch.Count(), scratch.m_shadowVisible.data() );
+			}
+			else
+			{
+				std::ranges::fill( scratch.m_shadowVisible, uint8{ 0 } );
+			}
+
+			// Both passes work from view space, so the instance data only goes up once.
+			TransformBatch::MultiplyAffine( g_frameScene.camera.view, scratch.m_renderMatrices.data(), scratch.Count(), scratch.m_viewModelMatrices.data() );
+			TransformBatch::GetNormalMatrices( scratch.m_viewModelMatrices.data(), scratch.Count(), scratch.m_normalMatrices.data() );
+			g_renderState.Stats().m_shadowMeshesDrawn = BatchVisibleInstances( scratch.m_shadowVisible, scratch, scratch.m_shadowBatches );
+			g_renderState.Stats().m_mainMeshesDrawn = BatchVisibleInstances( scratch.m_mainVisible, scratch, scratch.m_mainBatches );
+			if ( !scratch.m_instances.empty() )
+			{
+				g_renderState.UpdateBuffer( g_frameScene.modelInstanceBuffer, SG_RANGE_VEC( scratch.m_instances ) );
 			}
 
 
 			// RENDER_PASSES
-			Mat4 lightSpace{};
+			Mat4 const viewToLightSpace = lightSpace * glm::inverse( g_frameScene.camera.view );
 			if constexpr (g_enableDirectionalShadow)
 			{
 				g_renderState.NextPass(Pass_DirectionalLight);
-				g_renderState.SetRenderer(Renderer_DepthOnly);
 
-				Mat4 const lightProj = GetDirectionalLightOrthoMat( 10.0f, 1.0f, 50.0f );
-				Vec3 const lightPos = g_frameScene.camera.pos - ( lightsAccess->directionalDir * 25.0f );
-				Mat4 const lightView = glm::lookAt( lightPos, lightPos + lightsAccess->directionalDir, Vec3( 0.0f, 1.0f, 0.0f ) );
-				lightSpace = lightProj * lightView;
-
-				auto fnLightModelVisitor = [&lightSpace](Mat4 const& _modelMatrix, Resource::ModelData const& _model)
+				auto fnLightRendererSetup = [&viewToLightSpace]()
 				{
 					depth_only_vs_params_t vs_params = {
-						.projViewModel = lightSpace * _modelMatrix,
+						.viewToLightSpace = viewToLightSpace,
 					};
-
-					sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_depth_only_vs_params, SG_RANGE_REF(vs_params));
+					g_renderState.ApplyUniforms(SG_SHADERSTAGE_VS, SLOT_depth_only_vs_params, SG_RANGE_REF(vs_params));
 				};
 
-				auto fnLightMeshVisitor = [](Resource::MeshData const& _mesh)
+				auto fnLightMeshVisitor = [](ModelBatch const& _batch, Resource::MeshData const& _mesh)
 				{
 					sg_bindings bufOnlyBinds = _mesh.m_bindings;
 					std::memset(&bufOnlyBinds.vs_images, 0, sizeof(bufOnlyBinds.vs_images));
 					std::memset(&bufOnlyBinds.fs_images, 0, sizeof(bufOnlyBinds.fs_images));
+					BindModelInstances(_batch, bufOnlyBinds);
 					g_renderState.SetBinding(bufOnlyBinds, _mesh.NumToDraw());
 				};
 
-				RenderMainScene(fnLightModelVisitor, fnLightMeshVisitor);
+				RenderMainScene(scratch.m_shadowBatches, Renderer_DepthOnly, Renderer_DepthOnly_Index16, fnLightRendererSetup, fnLightMeshVisitor);
 
 				g_renderState.NextPass(Pass_MainTarget);
 			}
 
 			if constexpr (g_enableMainRenderer)
 			{
-				g_renderState.SetRenderer(Renderer_Main);
-				sg_apply_uniforms( SG_SHADERSTAGE_FS, SLOT_main_lights, SG_RANGE_REF( lightsAccess->shader_LightData() ) );
-
-				main_vs_params_t vs_params = {
-					.projection = g_frameScene.camera.proj,
-				};
-				sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_main_vs_params, SG_RANGE_REF(vs_params));
-
-				auto fnMainModelVisitor = [&lightSpace](Mat4 const& _modelMatrix, Resource::ModelData const& _model)
+				auto fnMainRendererSetup = [&lights, &viewToLightSpace]()
 				{
-					main_model_params_t model_params = {
-						.viewModel = g_frameScene.camera.view * _modelMatrix,
-						.normal = glm::transpose(glm::inverse(model_params.viewModel)),
-						.lightSpace = lightSpace * _modelMatrix,
-					};
+					g_renderState.ApplyUniforms( SG_SHADERSTAGE_FS, SLOT_main_lights, SG_RANGE_REF( lights.shader_LightData() ) );
 
-					sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_main_model_params, SG_RANGE_REF(model_params));
+					main_vs_params_t vs_params = {
+						.projection = g_frameScene.camera.proj,
+						.viewToLightSpace = viewToLightSpace,
+					};
+					g_renderState.ApplyUniforms(SG_SHADERSTAGE_VS, SLOT_main_vs_params, SG_RANGE_REF(vs_params));
 				};
 
-				auto fnMainMeshVisitor = [](Resource::MeshData const& _mesh)
+				auto fnMainMeshVisitor = [](ModelBatch const& _batch, Resource::MeshData const& _mesh)
 				{
 					sg_bindings addShadowBinds = _mesh.m_bindings;
 					addShadowBinds.fs_images[SLOT_main_directionalShadowMap] = g_frameScene.directionalShadowMap.GetSokolID();
+					BindModelInstances(_batch, addShadowBinds);
 					g_renderState.SetBinding(addShadowBinds, _mesh.NumToDraw());
-					sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_main_material, SG_RANGE_REF(_mesh.m_material));
+					g_renderState.ApplyUniforms(SG_SHADERSTAGE_FS, SLOT_main_material, SG_RANGE_REF(_mesh.m_material));
 				};
 
-				RenderMainScene(fnMainModelVisitor, fnMainMeshVisitor);
+				RenderMainScene(scratch.m_mainBatches, Renderer_Main, Renderer_Main_Index16, fnMainRendererSetup, fnMainMeshVisitor);
 			}
 
 			// render skybox (if exists)
@@ -770,12 +1047,12 @@ namespace Core
 					skybox_vs_params_t vs_params{
 						.untranslated_projView = g_frameScene.camera.proj * Mat4(Mat3(g_frameScene.camera.view)),
 					};
-					sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_skybox_vs_params, SG_RANGE_REF(vs_params));
+					g_renderState.ApplyUniforms(SG_SHADERSTAGE_VS, SLOT_skybox_vs_params, SG_RANGE_REF(vs_params));
 
 					skybox_fs_params_t fs_params{
-						.sunDir = lightsAccess->directionalDir,
+						.sunDir = lights.directionalDir,
 					};
-					sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_skybox_fs_params, SG_RANGE_REF(fs_params));
+					g_renderState.ApplyUniforms(SG_SHADERSTAGE_FS, SLOT_skybox_fs_params, SG_RANGE_REF(fs_params));
 
 					g_frameScene.skyboxBinds.fs_images[SLOT_skybox_skybox] = g_frameScene.skybox.GetSokolID();
 
@@ -791,20 +1068,26 @@ namespace Core
 			Core::Render::FrameData const& _rfd
 		)
 		{
+			Core::Profiling::Scope const profileScope{ "RenderSprites" };
 			g_frameScene.sceneSpriteData.RunRender(
-				[ &_rfd ]( std::vector<SpriteBufferData> const& _spriteBuffer )
+				[ &_rfd ]( std::vector<SpriteBufferData> const& _spriteBuffer, bool _bufferChanged )
 				{
-					sg_update_buffer( g_frameScene.sceneSpriteBuffer, SG_RANGE_VEC( _spriteBuffer ) );
+					// sokol can only replace a buffer's contents wholesale, so either everything in use goes up or nothing does.
+					if ( _bufferChanged )
+					{
+						g_renderState.UpdateBuffer( g_frameScene.sceneSpriteBuffer, SG_RANGE_VEC( _spriteBuffer ) );
+					}
 
 					g_renderState.NextPass( Pass_MainTarget );
 					g_renderState.SetRenderer( Renderer_Sprites );
 					sprites_vs_params_t vs_params{
 						.projection = GetSpriteOrthoMat( _rfd ),
 					};
-					sg_apply_uniforms( SG_SHADERSTAGE_VS, SLOT_sprites_vs_params, SG_RANGE_REF( vs_params ) );
+					g_renderState.ApplyUniforms( SG_SHADERSTAGE_VS, SLOT_sprites_vs_params, SG_RANGE_REF( vs_params ) );
 				},
 				[]( SpriteSceneData::DrawCall const& _drawCall )
 				{
+					++g_renderState.Stats().m_spriteBatches;
 					RenderSceneSpriteBuffer( _drawCall.vertexOffset, _drawCall.count, _drawCall.texture );
 				}
 			);
@@ -823,16 +1106,52 @@ namespace Core
 			render_target_to_screen_vs_params_t aspectData{
 				.aspectMult = (4.0f / 3.0f) * (_rfd.contextWindow.f.y / _rfd.contextWindow.f.x),
 			};
-			sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_render_target_to_screen_vs_params, SG_RANGE_REF(aspectData));
+			g_renderState.ApplyUniforms(SG_SHADERSTAGE_VS, SLOT_render_target_to_screen_vs_params, SG_RANGE_REF(aspectData));
 			g_renderState.Draw();
 		}
 
+		//--------------------------------------------------------------------------------
+		// Concatenates every thread's queue into the frame scene, leaving the queues empty for next frame.
+		static void GatherRenderQueues
+		(
+		)
+		{
+			auto queuesAccess = g_renderQueues.Read();
+			for (std::unique_ptr<RenderQueue> const& queue : *queuesAccess)
+			{
+				g_frameScene.models.insert(g_frameScene.models.end(), queue->m_models.begin(), queue->m_models.end());
+				queue->m_models.clear();
+
+				for (LightToDraw const& light : queue->m_lights)
+				{
+					LightSetter lightSetter = g_frameScene.lights.AddLight();
+					lightSetter.Col = light.m_col;
+					lightSetter.Pos = light.m_pos;
+					lightSetter.Att = light.m_att;
+					lightSetter.Dir = light.m_dir;
+					lightSetter.Cut = light.m_cut;
+				}
+				queue->m_lights.clear();
+
+				g_frameScene.lights.ambientLight += queue->m_ambientLight;
+				queue->m_ambientLight = {};
+
+				if (queue->m_directionalDir.has_value())
+				{
+					g_frameScene.lights.directionalDir = *queue->m_directionalDir;
+					queue->m_directionalDir.reset();
+				}
+			}
+		}
+
 		//--------------------------------------------------------------------------------
 		void Render
 		(
 			Core::Render::FrameData const& _rfd
 		)
 		{
+			GatherRenderQueues();
+
 			// Only do 3D stuff if main camera set.
 			if (g_renderState.IsMainCameraSet())
 			{
@@ -847,8 +1166,8 @@ namespace Core
 
 			// frameScene cleanup
 			g_frameScene.skybox = Resource::TextureSampleID{};
-			g_frameScene.lights.Write()->Reset();
-			g_frameScene.models.Write()->clear();
+			g_frameScene.lights.Reset();
+			g_frameScene.models.clear();
 
 			// end of the main drawing pass
 			// begin of the screen drawing pass
@@ -863,6 +1182,12 @@ namespace Core
 			g_renderState.Commit();
 		}
 
+		//--------------------------------------------------------------------------------
+		void StartFrame()
+		{
+			g_renderState.ResetStats();
+		}
+
 		//--------------------------------------------------------------------------------
 		void Cleanup()
 		{
@@ -876,22 +1201,29 @@ namespace Core
 			return g_frameScene.camera;
 		}
 
+		//--------------------------------------------------------------------------------
+		FrameStats const& GetFrameStats()
+		{
+			return g_renderState.LastFrameStats();
+		}
+
 		//--------------------------------------------------------------------------------
 		LightSetter AddLightThisFrame()
 		{
-			return g_frameScene.lights.Write()->AddLight();
+			LightToDraw& light = GetThreadRenderQueue().m_lights.emplace_back();
+			return LightSetter{ light.m_col, light.m_pos, light.m_att, light.m_dir, light.m_cut, };
 		}
 
 		//--------------------------------------------------------------------------------
 		void AddAmbientLightThisFrame(Vec3 const& _col)
 		{
-			g_frameScene.lights.Write()->ambientLight += _col;
+			GetThreadRenderQueue().m_ambientLight += _col;
 		}
 
 		//--------------------------------------------------------------------------------
 		void SetDirectionalLightDir(Vec3 const& _dir)
 		{
-			g_frameScene.lights.Write()->directionalDir = _dir;
+			GetThreadRenderQueue().m_directionalDir = _dir;
 		}
 
 		//--------------------------------------------------------------------------------
@@ -925,6 +1257,12 @@ namespace Core
 			g_frameScene.sceneSpriteData.Erase( _sprite );
 		}
 
+		//--------------------------------------------------------------------------------
+		void RefreshSpritesInScene()
+		{
+			g_frameScene.sceneSpriteData.RefreshSpriteData();
+		}
+
 		//--------------------------------------------------------------------------------
 		void DrawModelThisFrame
 		(
@@ -932,7 +1270,7 @@ namespace Core
 			Trans const& _worldTrans
 		)
 		{
-			g_frameScene.models.Write()->emplace_back(_model, _worldTrans);
+			GetThreadRenderQueue().m_models.emplace_back(_model, _worldTrans);
 		}
 
 		//--------------------------------------------------------------------------------
@@ -24,19 +24,58 @@ namespace Core
 			Vec3 pos{};
 		};
 
+		// Counted over the last whole frame, up to the end of Render. Only covers what the render manager draws itself, not text, debug lines or ImGui.
+		struct FrameStats
+		{
+			usize m_drawCalls{ 0 };
+			usize m_uniformApplies{ 0 };
+			usize m_bindingsApplied{ 0 };
+			usize m_passSwitches{ 0 };
+			usize m_bytesUploaded{ 0 }; // through sg_update_buffer
+			usize m_verticesSubmitted{ 0 }; // by non-indexed draws, counting every instance
+			usize m_indicesSubmitted{ 0 }; // by indexed draws, counting every instance
+			usize m_spriteBatches{ 0 }; // one per texture change in the sprite draw order
+
+			usize m_submittedMeshes{ 0 }; // every mesh of every model queued
+			usize m_shadowMeshesDrawn{ 0 }; // after culling
+			usize m_mainMeshesDrawn{ 0 }; // after culling
+
+			FrameStats& operator+=(FrameStats const& _other)
+			{
+				m_drawCalls += _other.m_drawCalls;
+				m_uniformApplies += _other.m_uniformApplies;
+				m_bindingsApplied += _other.m_bindingsApplied;
+				m_passSwitches += _other.m_passSwitches;
+				m_bytesUploaded += _other.m_bytesUploaded;
+				m_verticesSubmitted += _other.m_verticesSubmitted;
+				m_indicesSubmitted += _other.m_indicesSubmitted;
+				m_spriteBatches += _other.m_spriteBatches;
+				m_submittedMeshes += _other.m_submittedMeshes;
+				m_shadowMeshesDrawn += _other.m_shadowMeshesDrawn;
+				m_mainMeshesDrawn += _other.m_mainMeshesDrawn;
+				return *this;
+			}
+		};
+
 		void Init();
 		void SetupPipeline(int _mainRenderWidth, int _mainRenderHeight);
 		void SetMainCameraParams(Core::Render::FrameData const& _rfd, Core::Render::MainCamera3D const& _cam, Core::Transform3D const& _t);
+		// Resets the frame's stats. Call before any systems run, as render work is counted from RENDER_PASS_START onwards.
+		void StartFrame();
 		void Render(Core::Render::FrameData const& _rfd);
 		void Cleanup();
 
 		CameraState const& GetCameraState();
+		FrameStats const& GetFrameStats();
 
 		[[nodiscard]] SpriteSceneID AddSpriteToScene( Core::Resource::SpriteID _sprite, Trans2D const& _screenTrans, uint32 _initFlags );
 		void UpdateSpriteInScene( SpriteSceneID _sprite, Trans2D const& _screenTrans, uint32 _flags );
 		void RemoveSpriteFromScene( SpriteSceneID _sprite );
+		// Picks up texture and UV changes to sprites already in the scene, e.g. after Resource::PackSpriteAtlases.
+		void RefreshSpritesInScene();
 
 		// Functions for adding graphics just this frame. The more this is done, the slower things are :)
+		// Safe to call from parallel systems, as each thread queues into its own buffer. A LightSetter is only valid until the next AddLightThisFrame on the same thread.
 		void DrawModelThisFrame(Core::Resource::ModelID _model, Trans const& _worldTrans);
 		void DrawSkyboxThisFrame(Core::Resource::TextureSampleID _skybox);
 		LightSetter AddLightThisFrame();
@@ -20,8 +20,10 @@ namespace Core::Render
 	enum e_Renderer
 	{
 		Renderer_Main,
+		Renderer_Main_Index16,
 		Renderer_TargetToScreen,
 		Renderer_DepthOnly,
+		Renderer_DepthOnly_Index16,
 		Renderer_Skybox,
 		Renderer_Sprites,
 
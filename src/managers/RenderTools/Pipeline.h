@@ -88,6 +88,7 @@ namespace Core::Render
 		bool Set( e_Pass _currentPass, e_Renderer _currentRenderer );
 
 		int NumToDraw() const { return m_numToDraw; }
+		bool IsIndexed() const { return m_bindings.index_buffer.id != SG_INVALID_ID; }
 
 		void AddValidPass( e_Pass _pass );
 		void AddValidRenderer( e_Renderer _renderer );
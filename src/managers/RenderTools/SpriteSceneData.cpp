@@ -2,13 +2,53 @@
 
 #include "managers/ResourceManager.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+
 namespace Core::Render
 {
 
+//--------------------------------------------------------------------------------
+void SpriteSceneData::ProcessCompaction()
+{
+	if ( m_numTombstones > 0 )
+	{
+		usize writeI = 0;
+		for ( usize readI{ 0 }; readI < m_ordering.size(); ++readI )
+		{
+			SpriteSceneID const sceneSprite = m_ordering[ readI ];
+			if ( sceneSprite.IsNull() )
+			{
+				continue;
+			}
+
+			if ( writeI != readI )
+			{
+				m_ordering[ writeI ] = sceneSprite;
+				m_spriteBuffer[ writeI ] = m_spriteBuffer[ readI ];
+				m_sceneSpriteData[ sceneSprite ].m_pos = writeI;
+			}
+			++writeI;
+		}
+
+		m_ordering.resize( writeI );
+		m_spriteBuffer.erase( m_spriteBuffer.begin() + writeI, m_spriteBuffer.end() );
+		m_numTombstones = 0;
+
+		m_callListDirty = true;
+		m_bufferDirty.store( true, std::memory_order_relaxed );
+	}
+}
+
 //--------------------------------------------------------------------------------
 void SpriteSceneData::ProcessReorder()
 {
-	if ( m_orderDirty )
+	if ( m_orderDirty && m_numNeedingReorder.load( std::memory_order_relaxed ) > GetFullReorderThreshold() )
+	{
+		FullReorder();
+	}
+	else if ( m_orderDirty )
 	{
 		for ( auto const& [sceneSpriteID, spriteData] : m_sceneSpriteData )
 		{
@@ -19,7 +59,95 @@ void SpriteSceneData::ProcessReorder()
 		}
 
 		m_orderDirty = false;
+		m_numNeedingReorder.store( 0, std::memory_order_relaxed );
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Sprites are drawn in key order: opaque before alpha, alpha sorted back to front by z, then grouped by texture to batch draw calls.
+uint64 SpriteSceneData::GetSortKey( usize _pos ) const
+{
+	SpriteData const& spriteData = m_sceneSpriteData[ m_ordering[ _pos ] ];
+
+	uint64 key = spriteData.m_texture.GetValue() & 0xFFFFu; // sokol's slot index is unique among live images
+	if ( spriteData.m_useAlpha )
+	{
+		// flip floats so that they sort correctly as unsigned ints
+		uint32 zBits = std::bit_cast< uint32 >( m_spriteBuffer[ _pos ].m_position.z );
+		zBits ^= ( zBits & 0x8000'0000u ) != 0 ? 0xFFFF'FFFFu : 0x8000'0000u;
+
+		key |= uint64{ 1 } << 48;
+		key |= uint64{ zBits } << 16;
 	}
+	return key;
+}
+
+//--------------------------------------------------------------------------------
+// Rebuilds the whole ordering with an LSD radix sort on the sort keys, for when too many sprites have moved for Reorder to be cheap.
+void SpriteSceneData::FullReorder()
+{
+	usize const count = m_ordering.size();
+	std::vector<SortEntry>& entries = m_sortScratch[ 0 ];
+	std::vector<SortEntry>& swapEntries = m_sortScratch[ 1 ];
+	entries.resize( count );
+	swapEntries.resize( count );
+
+	for ( usize pos{ 0 }; pos < count; ++pos )
+	{
+		entries[ pos ] = { GetSortKey( pos ), static_cast< uint32 >( pos ) };
+	}
+
+	// keys only use the bottom 49 bits
+	for ( uint32 shift{ 0 }; shift < 56; shift += 8 )
+	{
+		std::array<usize, 256> offsets{};
+		for ( SortEntry const& entry : entries )
+		{
+			++offsets[ ( entry.m_key >> shift ) & 0xFFu ];
+		}
+
+		// every key has the same digit, nothing would move
+		if ( offsets[ ( entries[ 0 ].m_key >> shift ) & 0xFFu ] == count )
+		{
+			continue;
+		}
+
+		usize total = 0;
+		for ( usize& offset : offsets )
+		{
+			usize const bucketCount = offset;
+			offset = total;
+			total += bucketCount;
+		}
+
+		for ( SortEntry const& entry : entries )
+		{
+			swapEntries[ offsets[ ( entry.m_key >> shift ) & 0xFFu ]++ ] = entry;
+		}
+		std::swap( entries, swapEntries );
+	}
+
+	m_orderingScratch.clear();
+	m_spriteBufferScratch.clear();
+	m_orderingScratch.reserve( count );
+	m_spriteBufferScratch.reserve( count );
+	for ( usize pos{ 0 }; pos < count; ++pos )
+	{
+		SpriteSceneID const sceneSprite = m_ordering[ entries[ pos ].m_index ];
+		m_orderingScratch.emplace_back( sceneSprite );
+		m_spriteBufferScratch.emplace_back( m_spriteBuffer[ entries[ pos ].m_index ] );
+
+		SpriteData& spriteData = m_sceneSpriteData[ sceneSprite ];
+		spriteData.m_pos = pos;
+		spriteData.m_needsReorder = false;
+	}
+	std::swap( m_ordering, m_orderingScratch );
+	std::swap( m_spriteBuffer, m_spriteBufferScratch );
+
+	m_orderDirty = false;
+	m_numNeedingReorder.store( 0, std::memory_order_relaxed );
+	m_callListDirty = true;
+	m_bufferDirty.store( true, std::memory_order_relaxed );
 }
 
 //--------------------------------------------------------------------------------
@@ -62,25 +190,31 @@ void SpriteSceneData::ProcessDrawCallList()
 
 //--------------------------------------------------------------------------------
 SpriteSceneID SpriteSceneData::Add( Resource::SpriteID _sprite, Trans2D const& _screenTrans, uint32 _flags )
+{
+	return Add( _sprite, Core::Resource::GetSprite( _sprite ), _screenTrans, _flags );
+}
+
+//--------------------------------------------------------------------------------
+SpriteSceneID SpriteSceneData::Add( Resource::SpriteID _sprite, Resource::SpriteData const& _spriteData, Trans2D const& _screenTrans, uint32 _flags )
 {
 	absl::MutexLock lock( &m_mutex );
 
-	Resource::SpriteData const& spriteData = Core::Resource::GetSprite( _sprite );
-	SpriteSceneID const sceneSprite = m_sceneSpriteData.Emplace( _sprite, m_ordering.size(), spriteData.m_texture, spriteData.m_useAlpha );
+	SpriteSceneID const sceneSprite = m_sceneSpriteData.Emplace( _sprite, m_ordering.size(), _spriteData.m_texture, _spriteData.m_useAlpha );
 	m_ordering.emplace_back( sceneSprite );
 	m_spriteBuffer.emplace_back(
 		Vec3( _screenTrans.m_pos, _screenTrans.m_z ),
 		_screenTrans.m_scale,
 		_screenTrans.m_rot.m_rads,
-		spriteData.m_topLeftUV,
-		spriteData.m_dimensionsUV,
-		spriteData.m_dimensions,
+		_spriteData.m_topLeftUV,
+		_spriteData.m_dimensionsUV,
+		_spriteData.m_dimensions,
 		_flags
 	);
 
 	MarkForReorder( sceneSprite );
 
 	m_callListDirty = true;
+	m_bufferDirty.store( true, std::memory_order_relaxed );
 
 	kaAssert( m_ordering.size() < c_maxSprites );
 
@@ -92,27 +226,55 @@ void SpriteSceneData::Erase( SpriteSceneID _sprite )
 {
 	absl::MutexLock lock( &m_mutex );
 
-	usize pos = FindSprite( _sprite );
-	m_ordering.erase( m_ordering.begin() + pos );
-	m_spriteBuffer.erase( m_spriteBuffer.begin() + pos );
+	// Just leave a tombstone, compacted in one pass at RunRender so that removing many sprites doesn't shift everything each time.
+	usize const pos = FindSprite( _sprite );
+	m_ordering[ pos ] = SpriteSceneID{};
 	m_sceneSpriteData.Erase( _sprite );
+	++m_numTombstones;
+}
+
+//--------------------------------------------------------------------------------
+void SpriteSceneData::RefreshSpriteData()
+{
+	absl::MutexLock lock( &m_mutex );
+
+	for ( auto [sceneSprite, spriteData] : m_sceneSpriteData )
+	{
+		Resource::SpriteData const& resourceData = Core::Resource::GetSprite( spriteData.m_sprite );
+		if ( spriteData.m_texture == resourceData.m_texture )
+		{
+			continue;
+		}
+
+		spriteData.m_texture = resourceData.m_texture;
+		SpriteBufferData& sbData = m_spriteBuffer[ spriteData.m_pos ];
+		sbData.m_topLeftUV = resourceData.m_topLeftUV;
+		sbData.m_UVDims = resourceData.m_dimensionsUV;
+
+		// the texture is part of the sort key
+		MarkForReorder( sceneSprite );
+		m_callListDirty = true;
+		m_bufferDirty.store( true, std::memory_order_relaxed );
+	}
 }
 
 //--------------------------------------------------------------------------------
 void SpriteSceneData::RunRender
 (
-	std::function< void( std::vector<SpriteBufferData> const& ) > const& _start,
+	std::function< void( std::vector<SpriteBufferData> const&, bool ) > const& _start,
 	std::function< void( DrawCall const& )> const& _draw
 )
 {
 	absl::MutexLock lock( &m_mutex );
 
+	ProcessCompaction();
+
 	if ( !m_spriteBuffer.empty() )
 	{
 		ProcessReorder();
 		ProcessDrawCallList();
 
-		_start( m_spriteBuffer );
+		_start( m_spriteBuffer, m_bufferDirty.exchange( false, std::memory_order_relaxed ) );
 
 		for ( SpriteSceneData::DrawCall const& call : m_drawCallList )
 		{
@@ -122,6 +284,12 @@ void SpriteSceneData::RunRender
 	}
 }
 
+//--------------------------------------------------------------------------------
+usize SpriteSceneData::GetFullReorderThreshold() const
+{
+	return m_fullReorderThresholdOverride.value_or( std::max( c_fullReorderThreshold, m_ordering.size() / c_fullReorderSceneDivisor ) );
+}
+
 //--------------------------------------------------------------------------------
 usize SpriteSceneData::FindSprite( SpriteSceneID _sprite ) const
 {
@@ -131,7 +299,12 @@ usize SpriteSceneData::FindSprite( SpriteSceneID _sprite ) const
 //--------------------------------------------------------------------------------
 void SpriteSceneData::MarkForReorder( SpriteSceneID _sprite )
 {
-	m_sceneSpriteData[ _sprite ].m_needsReorder = true;
+	SpriteData& spriteData = m_sceneSpriteData[ _sprite ];
+	if ( !spriteData.m_needsReorder )
+	{
+		spriteData.m_needsReorder = true;
+		m_numNeedingReorder.fetch_add( 1, std::memory_order_relaxed );
+	}
 	m_orderDirty = true;
 }
 
@@ -143,36 +316,7 @@ void SpriteSceneData::Reorder( SpriteSceneID _sprite )
 
 	auto isLess = [this]( usize _a, usize _b )
 	{
-		// Explanation:
-		// a and b both alpha - sort by Z, then sort by texture (lessZ || lessTex)
-		// a alpha, b not - a must be above b (false)
-		// b alpha, a not - b must be above a (true)
-		// a and b not alpha - sort by texture (lessTex)
-		/*if ( bSpriteData.m_useAlpha )
-		{
-			if ( aSpriteData.m_useAlpha )
-			{
-				return _a.m_transform.m_z < _b.m_transform.m_z || aSpriteData.m_texture < bSpriteData.m_texture;
-			}
-			else
-			{
-				return true;
-			}
-		}
-		else if ( aSpriteData.m_useAlpha )
-		{
-			return false;
-		}
-		else
-		{
-			return aSpriteData.m_texture < bSpriteData.m_texture;
-		}*/
-		SpriteData const& a = m_sceneSpriteData[ m_ordering[ _a ] ];
-		SpriteData const& b = m_sceneSpriteData[ m_ordering[ _b ] ];
-		bool const lessTexture = a.m_texture < b.m_texture;
-		bool const lessZ = m_spriteBuffer[ _a ].m_position.z < m_spriteBuffer[ _b ].m_position.z;
-		bool const equalAlpha = a.m_useAlpha == b.m_useAlpha;
-		return ( !equalAlpha && b.m_useAlpha ) || ( equalAlpha && ( ( b.m_useAlpha && lessZ ) || lessTexture ) );
+		return GetSortKey( _a ) <= GetSortKey( _b );
 	};
 
 	while ( curPos > 0u )
@@ -188,6 +332,7 @@ void SpriteSceneData::Reorder( SpriteSceneID _sprite )
 		std::swap( m_spriteBuffer[ prevPos ], m_spriteBuffer[ curPos ] );
 		curPos--;
 		m_callListDirty = true;
+		m_bufferDirty.store( true, std::memory_order_relaxed );
 	}
 
 	while ( curPos < m_ordering.size() - 1u )
@@ -203,6 +348,7 @@ void SpriteSceneData::Reorder( SpriteSceneID _sprite )
 		std::swap( m_spriteBuffer[ curPos ], m_spriteBuffer[ nextPos ] );
 		curPos++;
 		m_callListDirty = true;
+		m_bufferDirty.store( true, std::memory_order_relaxed );
 	}
 
 }
@@ -216,11 +362,20 @@ void SpriteSceneData::Update
 )
 {
 	SpriteBufferData& sbData = m_spriteBuffer[ FindSprite( _sprite ) ];
+	Vec3 const newPosition( _screenTrans.m_pos, _screenTrans.m_z );
+
+	// Most sprites don't move most frames, so only dirty the buffer on an actual change.
+	if ( sbData.m_position == newPosition && sbData.m_scale == _screenTrans.m_scale && sbData.m_rotation == _screenTrans.m_rot.m_rads && sbData.m_flags == _flags )
+	{
+		return;
+	}
+
 	Vec1 const prevZ = sbData.m_position.z;
-	sbData.m_position = Vec3( _screenTrans.m_pos, _screenTrans.m_z );
+	sbData.m_position = newPosition;
 	sbData.m_scale = _screenTrans.m_scale;
 	sbData.m_rotation = _screenTrans.m_rot.m_rads;
 	sbData.m_flags = _flags;
+	m_bufferDirty.store( true, std::memory_order_relaxed );
 
 	if ( prevZ != _screenTrans.m_z )
 	{
@@ -7,13 +7,24 @@
 #include "managers/ResourceIDs.h"
 #include "managers/RenderIDs.h"
 
+#include <atomic>
 #include <vector>
 #include <functional>
+#include <optional>
+
+namespace Core::Resource
+{
+struct SpriteData;
+}
 
 namespace Core::Render
 {
 
 inline constexpr usize c_maxSprites = 262'144;
+// Above this many sprites needing a reorder in one frame, or a quarter of the scene if that's more, the whole scene is re-sorted instead of moving each one into place.
+// Reorder's cost grows with how far each sprite moves and FullReorder's with the scene size, so the crossover (see drift_headless --bench spritereorder) scales with the scene.
+inline constexpr usize c_fullReorderThreshold = 64;
+inline constexpr usize c_fullReorderSceneDivisor = 4;
 
 //--------------------------------------------------------------------------------
 struct SpriteBufferData
@@ -64,16 +75,43 @@ private:
 	std::vector<DrawCall> m_drawCallList;
 	bool m_callListDirty{ false };
 	bool m_orderDirty{ false };
+	// Erased sprites leave a null ID in m_ordering until the next RunRender compacts them away.
+	usize m_numTombstones{ 0 };
+	std::atomic<usize> m_numNeedingReorder{ 0 };
+	std::optional<usize> m_fullReorderThresholdOverride;
+
+	// Scratch for full reorders, kept around to avoid reallocating each time.
+	struct SortEntry
+	{
+		uint64 m_key;
+		uint32 m_index;
+	};
+	std::vector<SortEntry> m_sortScratch[ 2 ];
+	std::vector<SpriteSceneID> m_orderingScratch;
+	std::vector<SpriteBufferData> m_spriteBufferScratch;
+	// Set whenever m_spriteBuffer changes, so the GPU copy is only re-uploaded when needed. Atomic as Update runs in parallel.
+	std::atomic<bool> m_bufferDirty{ false };
 	absl::Mutex m_mutex;
 
+	void ProcessCompaction();
 	void ProcessReorder();
+	void FullReorder();
+	uint64 GetSortKey( usize _pos ) const;
 	void ProcessDrawCallList();
 
 public:
 	// The following operations are thread-safe amongst themselves, but not with the other operations
 	SpriteSceneID Add( Resource::SpriteID _sprite, Trans2D const& _screenTrans, uint32 _flags );
+	// As above, with the sprite's resource data passed in rather than looked up, e.g. for benchmarking with made up sprites.
+	SpriteSceneID Add( Resource::SpriteID _sprite, Resource::SpriteData const& _spriteData, Trans2D const& _screenTrans, uint32 _flags );
 	void Erase( SpriteSceneID _sprite );
-	void RunRender( std::function< void( std::vector<SpriteBufferData> const& ) > const& _start, std::function< void( DrawCall const& ) > const& _draw );
+	// Re-reads texture and UVs from the resource manager, for sprites whose resource data changed after they were added, e.g. by atlas packing.
+	void RefreshSpriteData();
+	// _start is told whether the sprite buffer changed since the last RunRender, i.e. whether it needs uploading again.
+	void RunRender( std::function< void( std::vector<SpriteBufferData> const&, bool ) > const& _start, std::function< void( DrawCall const& ) > const& _draw );
+	// Replaces the default threshold, for benchmarking. 0 always does a full reorder, ~0u never does.
+	void SetFullReorderThreshold( usize _threshold ) { m_fullReorderThresholdOverride = _threshold; }
+	usize GetFullReorderThreshold() const;
 
 	// The following operations are thread-safe amongst themselves, but not with the other operations
 	usize FindSprite( SpriteSceneID _sprite ) const;
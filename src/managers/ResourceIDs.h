@@ -4,6 +4,17 @@
 
 namespace Core::Resource
 {
+	// Kinds of file that can be loaded by path, e.g. by preloading.
+	enum class FileType
+	{
+		Model,
+		Texture2D,
+		Cubemap,
+		Sprite,
+		SFX,
+		BGM,
+	};
+
 	using TextureID = SokolIDWrapper<sg_image, true>;
 	using TextureSampleID = SokolIDWrapper<sg_image, false>;
 
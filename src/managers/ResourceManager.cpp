@@ -1,6 +1,7 @@
 #include "ResourceManager.h"
 
 #include "common/StaticVector.h"
+#include "systems/Core/ProfilingSystems.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -10,16 +11,29 @@
 #include <fstream>
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/inlined_vector.h>
+#include <absl/synchronization/mutex.h>
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <variant>
 
 #include <stb_image.h>
+#include <stb_dxt.h>
 
 #include <sokol_fetch.h>
+#include <sokol_time.h>
 
 #include "shaders/main.h"
 
 static Core::Resource::TextureSampleID g_defaultTextureID{}; // used for missing textures
 static Core::Resource::TextureSampleID g_defaultNormalTextureID{}; // used for missing normal textures
+static bool g_useCompressedTextures{ false }; // set once the backend is known, before anything loads
 static StaticVector<Core::Resource::TextureID, Core::Resource::TextureData> g_textures;
 static StaticVector<Core::Resource::ModelID, Core::Resource::ModelData> g_models;
 
@@ -29,6 +43,13 @@ static StaticVector<Core::Resource::SpriteID, Core::Resource::SpriteData> g_spri
 static StaticVector<Core::Resource::SoundEffectID, Core::Resource::SoundEffectData> g_soundEffects;
 static StaticVector<Core::Resource::MusicID, Core::Resource::MusicData> g_music;
 
+// path -> ID for each of the above, so finding an existing resource doesn't scan every loaded one.
+static absl::flat_hash_map<std::string, Core::Resource::TextureID> g_textureIDs;
+static absl::flat_hash_map<std::string, Core::Resource::ModelID> g_modelIDs;
+static absl::flat_hash_map<std::string, Core::Resource::SpriteID> g_spriteIDs;
+static absl::flat_hash_map<std::string, Core::Resource::SoundEffectID> g_soundEffectIDs;
+static absl::flat_hash_map<std::string, Core::Resource::MusicID> g_musicIDs;
+
 namespace
 {
 	constexpr uint8 const g_textureNormalOne = 0xFF;
@@ -39,11 +60,15 @@ namespace Core
 {
 	namespace Resource
 	{
+		static void StartLoadingThreads();
+		static void StopLoadingThreads();
+
 		//--------------------------------------------------------------------------------
 		void Init()
 		{
 			stbi_set_flip_vertically_on_load(false);
 			sfetch_setup(sfetch_desc_t{});
+			StartLoadingThreads();
 		}
 
 		//--------------------------------------------------------------------------------
@@ -80,11 +105,24 @@ namespace Core
 				};
 				g_defaultNormalTextureID = sg_make_image(emptyTexDesc);
 			}
+
+			g_useCompressedTextures = sg_query_pixelformat(SG_PIXELFORMAT_BC1_RGBA).sample && sg_query_pixelformat(SG_PIXELFORMAT_BC3_RGBA).sample;
+		}
+
+		//--------------------------------------------------------------------------------
+		void SetUseCompressedTextures
+		(
+			bool _use
+		)
+		{
+			kaAssert(g_textureIDs.empty(), "textures have already been loaded");
+			g_useCompressedTextures = _use;
 		}
 
 		//--------------------------------------------------------------------------------
 		void Cleanup()
 		{
+			StopLoadingThreads();
 			sfetch_shutdown();
 		}
 
@@ -95,24 +133,124 @@ namespace Core
 		SoundEffectData& GetSoundEffect( SoundEffectID _soundEffect ) { return g_soundEffects[ _soundEffect ]; }
 		MusicData& GetMusic( MusicID _music ) { return g_music[ _music ]; }
 
+		//--------------------------------------------------------------------------------
+		usize GetTotalTextureBytes()
+		{
+			usize totalBytes{ 0 };
+			for (auto const& [textureID, texture] : g_textures)
+			{
+				totalBytes += texture.m_sizeInBytes;
+			}
+			return totalBytes;
+		}
+
+		// Loading is split in two. Decode* functions read and decode a file into CPU memory, and touch no globals so can run on a loading thread.
+		// Register* functions then create any GPU resources and add the result to the globals, so must run on the main thread.
 
 		//--------------------------------------------------------------------------------
-		/// texture
+		template<typename T_ID>
+		static T_ID FindByPath
+		(
+			absl::flat_hash_map<std::string, T_ID> const& _ids,
+			std::string const& _path
+		)
+		{
+			auto const idI = _ids.find(_path);
+			return idI != _ids.end() ? idI->second : T_ID{};
+		}
+
 		//--------------------------------------------------------------------------------
-		static TextureID FindExistingTexture
+		/// cooked files
+		//--------------------------------------------------------------------------------
+		// Some resources are cooked into a file next to their source the first time they're loaded, and read from that afterwards.
+		// The source's write time is stored in the cooked file, so it's only used while the source is unchanged.
+		static std::string GetCookedPath
 		(
-			std::string const& _texPath
+			std::string const& _path
 		)
 		{
-			for (auto const& [textureID, texture] : g_textures)
+			return _path + ".cooked";
+		}
+
+		// Cooked files are written to a temporary and swapped in, so a partial file is never read back.
+		// Named per thread, as the same file can be decoded by more than one loading thread at once.
+		static std::string GetCookedTempPath
+		(
+			std::string const& _cookedPath
+		)
+		{
+			return std::format("{:s}.tmp{:d}", _cookedPath, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+		}
+
+		static std::optional<int64> GetWriteTime
+		(
+			std::string const& _path
+		)
+		{
+			std::error_code error;
+			std::filesystem::file_time_type const writeTime = std::filesystem::last_write_time(_path, error);
+			if (error)
 			{
-				if (texture.m_path == _texPath)
-				{
-					return textureID;
-				}
+				return std::nullopt;
 			}
+			return static_cast<int64>(writeTime.time_since_epoch().count());
+		}
 
-			return TextureID{};
+		//--------------------------------------------------------------------------------
+		template<typename T>
+		static bool ReadBinary
+		(
+			std::ifstream& _file,
+			T* o_values,
+			usize _count = 1
+		)
+		{
+			return static_cast<bool>(_file.read(reinterpret_cast<char*>(o_values), static_cast<std::streamsize>(sizeof(T) * _count)));
+		}
+
+		template<typename T>
+		static void WriteBinary
+		(
+			std::ofstream& _file,
+			T const* _values,
+			usize _count = 1
+		)
+		{
+			_file.write(reinterpret_cast<char const*>(_values), static_cast<std::streamsize>(sizeof(T) * _count));
+		}
+
+		//--------------------------------------------------------------------------------
+		static void CommitCookedFile
+		(
+			std::ofstream& io_tempFile,
+			std::string const& _tempPath,
+			std::string const& _cookedPath
+		)
+		{
+			bool const written = static_cast<bool>(io_tempFile);
+			io_tempFile.close();
+
+			// Failing to cook isn't an error, the source just gets loaded again next time.
+			std::error_code error;
+			if (written && !io_tempFile.fail())
+			{
+				std::filesystem::rename(_tempPath, _cookedPath, error);
+			}
+			else
+			{
+				std::filesystem::remove(_tempPath, error);
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		/// texture
+		//--------------------------------------------------------------------------------
+		static TextureID FindExistingTexture
+		(
+			std::string const& _texPath
+		)
+		{
+			return FindByPath(g_textureIDs, _texPath);
 		}
 
 		static bool CheckRGBAForAlpha
@@ -148,88 +286,340 @@ namespace Core
 		}
 
 		//--------------------------------------------------------------------------------
-		static bool LoadCubemapFromFile
+		struct STBIFree
+		{
+			void operator()(uint8* _data) const { stbi_image_free(_data); }
+		};
+
+		struct DecodedTexture
+		{
+			static constexpr int c_dataComponentCount{ 4 };
+
+			std::string m_path;
+			std::unique_ptr<uint8, STBIFree> m_data;
+			int m_width{ 0 };
+			int m_height{ 0 };
+			int m_imageComponentCount{ 0 };
+			bool m_semitransparent{ false };
+
+			// Set when block compressed, in which case m_data is null and the whole mip chain is here instead.
+			sg_pixel_format m_compressedFormat{ SG_PIXELFORMAT_NONE };
+			std::vector<std::vector<uint8>> m_compressedMips;
+
+			usize DataSize() const { return static_cast<usize>(m_width) * static_cast<usize>(m_height) * static_cast<usize>(c_dataComponentCount); }
+		};
+
+		//--------------------------------------------------------------------------------
+		/// compressed texture
+		//--------------------------------------------------------------------------------
+		// Material textures are block compressed with a full mip chain on first load, and cooked so later loads are a single read.
+		// Bump the version whenever the file layout or the compression changes.
+		static constexpr uint32 c_cookedTextureMagic{ 'd' | ('r' << 8) | ('t' << 16) | ('c' << 24) };
+		static constexpr uint32 c_cookedTextureVersion{ 1 };
+
+		struct CookedTextureHeader
+		{
+			uint32 m_magic{ c_cookedTextureMagic };
+			uint32 m_version{ c_cookedTextureVersion };
+			int64 m_sourceWriteTime{ 0 };
+			int32 m_width{ 0 };
+			int32 m_height{ 0 };
+			uint32 m_pixelFormat{ 0 };
+			uint32 m_numMips{ 0 };
+			uint32 m_semitransparent{ 0 };
+		};
+
+		//--------------------------------------------------------------------------------
+		static bool UseCompressedTexture
 		(
-			std::string const& _cubemapPath,
-			sg_image& o_imageID
+			TextureData::Type _type
 		)
 		{
-			sg_image_desc imageDesc{
-				.type = SG_IMAGETYPE_CUBE,
-				.pixel_format = SG_PIXELFORMAT_RGBA8,
-				.min_filter = SG_FILTER_LINEAR,
-				.mag_filter = SG_FILTER_LINEAR,
-				.wrap_u = SG_WRAP_CLAMP_TO_EDGE,
-				.wrap_v = SG_WRAP_CLAMP_TO_EDGE,
-				.wrap_w = SG_WRAP_CLAMP_TO_EDGE,
-				.label = _cubemapPath.c_str(),
-			};
+			// Normal maps lose too much in BC1/BC3. Sprites and UI want exact pixels, and need them on the CPU to be atlased.
+			return g_useCompressedTextures && (_type == TextureData::Type::Diffuse || _type == TextureData::Type::Specular);
+		}
 
-			std::string const directory = _cubemapPath.substr(0, _cubemapPath.find_last_of('/') + 1);
-			std::array<std::string, 6> cubemapFilenames;
+		// D3D11 rejects block compressed textures whose top level isn't a whole number of 4x4 blocks. Smaller mips are fine.
+		static bool CanCompressTexture
+		(
+			int _width,
+			int _height
+		)
+		{
+			return _width % 4 == 0 && _height % 4 == 0;
+		}
+
+		static usize GetCompressedMipSize
+		(
+			sg_pixel_format _format,
+			int _width,
+			int _height
+		)
+		{
+			usize const numBlocks = static_cast<usize>((_width + 3) / 4) * static_cast<usize>((_height + 3) / 4);
+			return numBlocks * (_format == SG_PIXELFORMAT_BC1_RGBA ? 8u : 16u);
+		}
+
+		//--------------------------------------------------------------------------------
+		// Includes the full chain when mipmapped, as generate_mipmaps creates.
+		static usize GetRGBA8Size
+		(
+			int _width,
+			int _height,
+			bool _mipmapped
+		)
+		{
+			usize size{ 0 };
+			while (true)
 			{
-				std::ifstream cubemapFile{ _cubemapPath };
-				if (!cubemapFile.is_open())
+				size += static_cast<usize>(_width) * static_cast<usize>(_height) * 4u;
+				if (!_mipmapped || (_width == 1 && _height == 1))
 				{
-					kaError("failed to open cubemap " + _cubemapPath);
-					return false;
+					return size;
 				}
+				_width = std::max(1, _width / 2);
+				_height = std::max(1, _height / 2);
+			}
+		}
 
-				for (usize i = 0; i < 6; ++i)
+		//--------------------------------------------------------------------------------
+		// Box filter down to half size, clamping at odd edges.
+		static void DownsampleRGBA
+		(
+			uint8 const* _src,
+			int _width,
+			int _height,
+			std::vector<uint8>& o_dst
+		)
+		{
+			constexpr usize pixelSize = DecodedTexture::c_dataComponentCount;
+			int const dstWidth = std::max(_width / 2, 1);
+			int const dstHeight = std::max(_height / 2, 1);
+			o_dst.resize(static_cast<usize>(dstWidth) * dstHeight * pixelSize);
+
+			for (int y = 0; y < dstHeight; ++y)
+			{
+				int const y0 = std::min(y * 2, _height - 1);
+				int const y1 = std::min(y * 2 + 1, _height - 1);
+				for (int x = 0; x < dstWidth; ++x)
 				{
-					if (!std::getline(cubemapFile, cubemapFilenames[i]))
+					int const x0 = std::min(x * 2, _width - 1);
+					int const x1 = std::min(x * 2 + 1, _width - 1);
+					for (usize c = 0; c < pixelSize; ++c)
 					{
-						kaError("not enough lines in cubemap file");
-						return false;
+						uint32 const sum = _src[(static_cast<usize>(y0) * _width + x0) * pixelSize + c]
+							+ _src[(static_cast<usize>(y0) * _width + x1) * pixelSize + c]
+							+ _src[(static_cast<usize>(y1) * _width + x0) * pixelSize + c]
+							+ _src[(static_cast<usize>(y1) * _width + x1) * pixelSize + c];
+						o_dst[(static_cast<usize>(y) * dstWidth + x) * pixelSize + c] = static_cast<uint8>((sum + 2) / 4);
 					}
-					cubemapFilenames[i] = directory + cubemapFilenames[i];
 				}
 			}
+		}
 
-			for (usize i = 0; i < cubemapFilenames.size(); ++i)
+		//--------------------------------------------------------------------------------
+		static void CompressRGBA
+		(
+			uint8 const* _src,
+			int _width,
+			int _height,
+			sg_pixel_format _format,
+			std::vector<uint8>& o_blocks
+		)
+		{
+			constexpr usize pixelSize = DecodedTexture::c_dataComponentCount;
+			bool const useAlpha = _format == SG_PIXELFORMAT_BC3_RGBA;
+			usize const blockSize = useAlpha ? 16u : 8u;
+			o_blocks.resize(GetCompressedMipSize(_format, _width, _height));
+
+			std::array<uint8, 4 * 4 * pixelSize> block;
+			uint8* dst = o_blocks.data();
+			for (int blockY = 0; blockY < _height; blockY += 4)
 			{
-				const int dataComponentCount{ 4 };
-				int imageComponentCount{ 0 };
-				uint8* data = stbi_load(cubemapFilenames[i].c_str(), &imageDesc.width, &imageDesc.height, &imageComponentCount, dataComponentCount);
-				if (data != nullptr)
+				for (int blockX = 0; blockX < _width; blockX += 4)
 				{
-					kaAssert(imageComponentCount > 0);
-					usize const dataSize = static_cast<usize>(imageDesc.width) * static_cast<usize>(imageDesc.height) * static_cast<usize>(dataComponentCount);
-					kaAssert(imageComponentCount <= 3 || !CheckRGBAForAlpha(data, dataSize), "cubemap cannot use alpha");
+					// partial blocks at the edges repeat the last row/column
+					for (int y = 0; y < 4; ++y)
+					{
+						int const srcY = std::min(blockY + y, _height - 1);
+						for (int x = 0; x < 4; ++x)
+						{
+							int const srcX = std::min(blockX + x, _width - 1);
+							std::memcpy(&block[(static_cast<usize>(y) * 4 + x) * pixelSize], &_src[(static_cast<usize>(srcY) * _width + srcX) * pixelSize], pixelSize);
+						}
+					}
+					stb_compress_dxt_block(dst, block.data(), useAlpha ? 1 : 0, STB_DXT_HIGHQUAL);
+					dst += blockSize;
+				}
+			}
+		}
 
-					imageDesc.data.subimage[i][0] = {
-						.ptr = data,
-						.size = dataSize,
-					};
+		//--------------------------------------------------------------------------------
+		static void CompressTexture
+		(
+			DecodedTexture& io_texture
+		)
+		{
+			io_texture.m_compressedFormat = CheckRGBAForAlpha(io_texture.m_data.get(), io_texture.DataSize()) ? SG_PIXELFORMAT_BC3_RGBA : SG_PIXELFORMAT_BC1_RGBA;
+
+			std::vector<uint8> mip;
+			std::vector<uint8> nextMip;
+			uint8 const* src = io_texture.m_data.get();
+			int width = io_texture.m_width;
+			int height = io_texture.m_height;
+			while (true)
+			{
+				CompressRGBA(src, width, height, io_texture.m_compressedFormat, io_texture.m_compressedMips.emplace_back());
+				if (width == 1 && height == 1)
+				{
+					break;
 				}
-				else
+
+				DownsampleRGBA(src, width, height, nextMip);
+				std::swap(mip, nextMip);
+				src = mip.data();
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
+			}
+			kaAssert(io_texture.m_compressedMips.size() <= SG_MAX_MIPMAPS, "texture is too large for a full mip chain");
+
+			io_texture.m_data.reset();
+		}
+
+		//--------------------------------------------------------------------------------
+		static bool ReadCookedTexture
+		(
+			std::string const& _path,
+			DecodedTexture& o_texture
+		)
+		{
+			std::optional<int64> const sourceWriteTime = GetWriteTime(_path);
+			if (!sourceWriteTime.has_value())
+			{
+				return false;
+			}
+
+			std::ifstream cookedFile{ GetCookedPath(_path), std::ios::binary };
+			if (!cookedFile.is_open())
+			{
+				return false;
+			}
+
+			CookedTextureHeader header;
+			if (!ReadBinary(cookedFile, &header)
+				|| header.m_magic != c_cookedTextureMagic
+				|| header.m_version != c_cookedTextureVersion
+				|| header.m_sourceWriteTime != *sourceWriteTime
+				|| header.m_numMips == 0
+				|| header.m_numMips > SG_MAX_MIPMAPS
+				|| !CanCompressTexture(header.m_width, header.m_height))
+			{
+				return false;
+			}
+
+			o_texture.m_width = header.m_width;
+			o_texture.m_height = header.m_height;
+			o_texture.m_semitransparent = header.m_semitransparent != 0;
+			o_texture.m_compressedFormat = static_cast<sg_pixel_format>(header.m_pixelFormat);
+			if (o_texture.m_compressedFormat != SG_PIXELFORMAT_BC1_RGBA && o_texture.m_compressedFormat != SG_PIXELFORMAT_BC3_RGBA)
+			{
+				o_texture.m_compressedFormat = SG_PIXELFORMAT_NONE;
+				return false;
+			}
+
+			o_texture.m_compressedMips.resize(header.m_numMips);
+			int width = header.m_width;
+			int height = header.m_height;
+			for (std::vector<uint8>& mip : o_texture.m_compressedMips)
+			{
+				mip.resize(GetCompressedMipSize(o_texture.m_compressedFormat, width, height));
+				if (!ReadBinary(cookedFile, mip.data(), mip.size()))
 				{
-					kaError("Texture failed to load at path: " + cubemapFilenames[i]);
-					for (usize j = 0; j < i; ++j)
-					{
-						stbi_image_free(const_cast<void*>(imageDesc.data.subimage[j][0].ptr));
-					}
-					stbi_image_free(data);
+					o_texture.m_compressedFormat = SG_PIXELFORMAT_NONE;
+					o_texture.m_compressedMips.clear();
 					return false;
 				}
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
 			}
 
-			o_imageID = sg_make_image(imageDesc);
-			for (usize i = 0; i < cubemapFilenames.size(); ++i)
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------
+		static void WriteCookedTexture
+		(
+			DecodedTexture const& _texture
+		)
+		{
+			std::optional<int64> const sourceWriteTime = GetWriteTime(_texture.m_path);
+			if (!sourceWriteTime.has_value())
+			{
+				return;
+			}
+
+			std::string const cookedPath = GetCookedPath(_texture.m_path);
+			std::string const tempPath = GetCookedTempPath(cookedPath);
+			std::ofstream cookedFile{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!cookedFile.is_open())
+			{
+				return;
+			}
+
+			CookedTextureHeader const header{
+				.m_sourceWriteTime = *sourceWriteTime,
+				.m_width = _texture.m_width,
+				.m_height = _texture.m_height,
+				.m_pixelFormat = static_cast<uint32>(_texture.m_compressedFormat),
+				.m_numMips = static_cast<uint32>(_texture.m_compressedMips.size()),
+				.m_semitransparent = _texture.m_semitransparent ? 1u : 0u,
+			};
+			WriteBinary(cookedFile, &header);
+			for (std::vector<uint8> const& mip : _texture.m_compressedMips)
+			{
+				WriteBinary(cookedFile, mip.data(), mip.size());
+			}
+
+			CommitCookedFile(cookedFile, tempPath, cookedPath);
+		}
+
+		//--------------------------------------------------------------------------------
+		static bool DecodeTexture
+		(
+			std::string const& _path,
+			bool _compressed,
+			DecodedTexture& o_texture
+		)
+		{
+			o_texture.m_path = _path;
+			if (_compressed && ReadCookedTexture(_path, o_texture))
+			{
+				return true;
+			}
+
+			o_texture.m_data.reset(stbi_load(_path.c_str(), &o_texture.m_width, &o_texture.m_height, &o_texture.m_imageComponentCount, DecodedTexture::c_dataComponentCount));
+			if (o_texture.m_data == nullptr)
+			{
+				return false;
+			}
+
+			kaAssert(o_texture.m_imageComponentCount > 0);
+			o_texture.m_semitransparent = CheckRGBAForSemiTransparency(o_texture.m_data.get(), o_texture.DataSize());
+
+			// Textures that can't be block compressed stay RGBA8, and get no cooked file.
+			if (_compressed && CanCompressTexture(o_texture.m_width, o_texture.m_height))
 			{
-				stbi_image_free(const_cast<void*>(imageDesc.data.subimage[i][0].ptr));
+				CompressTexture(o_texture);
+				WriteCookedTexture(o_texture);
 			}
 			return true;
 		}
 
 		//--------------------------------------------------------------------------------
-		static bool LoadTextureFromFile
+		static TextureID RegisterTexture
 		(
-			std::string const& _filename,
-			sg_image& o_imageID,
-			bool& o_semitransparent,
-			int& o_width,
-			int& o_height
+			DecodedTexture const& _texture,
+			TextureData::Type _type
 		)
 		{
 			sg_image_desc imageDesc{
@@ -239,33 +629,69 @@ namespace Core
 				.mag_filter = SG_FILTER_LINEAR,
 				.wrap_u = SG_WRAP_REPEAT,
 				.wrap_v = SG_WRAP_REPEAT,
-				.label = _filename.c_str(),
+				.label = _texture.m_path.c_str(),
 			};
-
-			const int dataComponentCount{ 4 };
-			int imageComponentCount{ 0 };
-			uint8* data = stbi_load(_filename.c_str(), &imageDesc.width, &imageDesc.height, &imageComponentCount, dataComponentCount);
-			if (data != nullptr)
+			imageDesc.width = _texture.m_width;
+			imageDesc.height = _texture.m_height;
+			if (_texture.m_compressedFormat != SG_PIXELFORMAT_NONE)
+			{
+				imageDesc.generate_mipmaps = false;
+				imageDesc.pixel_format = _texture.m_compressedFormat;
+				imageDesc.num_mipmaps = static_cast<int>(_texture.m_compressedMips.size());
+				for (usize mip = 0; mip < _texture.m_compressedMips.size(); ++mip)
+				{
+					imageDesc.data.subimage[0][mip] = {
+						.ptr = _texture.m_compressedMips[mip].data(),
+						.size = _texture.m_compressedMips[mip].size(),
+					};
+				}
+			}
+			else
 			{
-				kaAssert(imageComponentCount > 0);
-				o_width = imageDesc.width;
-				o_height = imageDesc.height;
-
-				usize const dataSize = static_cast<usize>(imageDesc.width) * static_cast<usize>(imageDesc.height) * static_cast<usize>(dataComponentCount);
-				o_semitransparent = CheckRGBAForSemiTransparency(data, dataSize);
-
 				imageDesc.data.subimage[0][0] = {
-					.ptr = data,
-					.size = dataSize,
+					.ptr = _texture.m_data.get(),
+					.size = _texture.DataSize(),
 				};
+			}
 
-				o_imageID = sg_make_image(imageDesc);
-				stbi_image_free(data);
-				return true;
+			TextureID const textureID = g_textures.Insert(sg_make_image(imageDesc));
+			TextureData& newTextureData = g_textures[textureID];
+			newTextureData.m_path = _texture.m_path;
+			newTextureData.m_type = _type;
+			newTextureData.m_width = _texture.m_width;
+			newTextureData.m_height = _texture.m_height;
+			if (_texture.m_compressedFormat != SG_PIXELFORMAT_NONE)
+			{
+				for (std::vector<uint8> const& mip : _texture.m_compressedMips)
+				{
+					newTextureData.m_sizeInBytes += mip.size();
+				}
+			}
+			else
+			{
+				newTextureData.m_sizeInBytes = GetRGBA8Size(_texture.m_width, _texture.m_height, true);
 			}
+			g_textureIDs.emplace(_texture.m_path, textureID);
 
-			stbi_image_free(data);
-			return false;
+			kaLog("New 2D texture " + _texture.m_path + " loaded!");
+
+			return textureID;
+		}
+
+		//--------------------------------------------------------------------------------
+		// For decodes that happened off the main thread, as the same texture may have been loaded in the meantime.
+		static TextureID FindOrRegisterTexture
+		(
+			DecodedTexture const& _texture,
+			TextureData::Type _type
+		)
+		{
+			TextureID const existingTexture = FindExistingTexture(_texture.m_path);
+			if (existingTexture.IsValid())
+			{
+				return existingTexture;
+			}
+			return RegisterTexture(_texture, _type);
 		}
 
 		//--------------------------------------------------------------------------------
@@ -285,58 +711,240 @@ namespace Core
 			}
 
 			// if texture hasn't been loaded already, load it
-			sg_image imageID;
-			bool semitransparent{ false };
-			int width{ 0 };
-			int height{ 0 };
-
-			bool const loaded = LoadTextureFromFile(_path, imageID, o_semitransparent != nullptr ? *o_semitransparent : semitransparent, width, height);
-			if (!loaded)
+			DecodedTexture texture;
+			if (!DecodeTexture(_path, UseCompressedTexture(_type), texture))
 			{
 				kaError("Failed to load 2D texture " + _path);
 				return false;
 			}
 
-			o_textureID = g_textures.Insert(imageID);
-			TextureData& newTextureData = g_textures[o_textureID];
-			newTextureData.m_path = _path;
-			newTextureData.m_type = _type;
-			newTextureData.m_width = width;
-			newTextureData.m_height = height;
-
-			kaLog("New 2D texture " + _path + " loaded!");
-
+			if (o_semitransparent != nullptr)
+			{
+				*o_semitransparent = texture.m_semitransparent;
+			}
+			o_textureID = RegisterTexture(texture, _type);
 			return true;
 		}
 
 		//--------------------------------------------------------------------------------
-		/// model
+		/// cubemap
 		//--------------------------------------------------------------------------------
-		static ModelID FindExistingModel
-		(
-			std::string const& _modelPath
-		)
+		struct DecodedCubemap
 		{
-			for (auto const& [modelID, model] : g_models)
-			{
-				if (model.m_path == _modelPath)
-				{
-					return modelID;
+			std::string m_path;
+			std::array<DecodedTexture, 6> m_faces;
+#if DEBUG_TOOLS
+			// logged once registered, as decoding happens off the main thread.
+			Vec1 m_debug_decodeMs{ 0.0f };
+			Vec1 m_debug_sequentialDecodeMs{ 0.0f };
+#endif
+		};
+
+		//--------------------------------------------------------------------------------
+		static bool DecodeCubemap
+		(
+			std::string const& _cubemapPath,
+			DecodedCubemap& o_cubemap
+		)
+		{
+			o_cubemap.m_path = _cubemapPath;
+
+			std::string const directory = _cubemapPath.substr(0, _cubemapPath.find_last_of('/') + 1);
+			std::array<std::string, 6> cubemapFilenames;
+			{
+				std::ifstream cubemapFile{ _cubemapPath };
+				if (!cubemapFile.is_open())
+				{
+					kaError("failed to open cubemap " + _cubemapPath);
+					return false;
+				}
+
+				for (usize i = 0; i < 6; ++i)
+				{
+					if (!std::getline(cubemapFile, cubemapFilenames[i]))
+					{
+						kaError("not enough lines in cubemap file");
+						return false;
+					}
+					cubemapFilenames[i] = directory + cubemapFilenames[i];
+				}
+			}
+
+			// Each face is a large image, so decoding them one after another makes skyboxes the slowest thing to load.
+			// The faces are decoded on their own threads instead, with the calling thread taking the first.
+			std::array<bool, 6> facesDecoded{};
+#if DEBUG_TOOLS
+			std::array<uint64, 6> faceTicks{};
+			uint64 const startTicks = stm_now();
+#endif
+			{
+				auto const decodeFace = [&](usize _face)
+				{
+#if DEBUG_TOOLS
+					uint64 const faceStartTicks = stm_now();
+#endif
+					facesDecoded[_face] = DecodeTexture(cubemapFilenames[_face], false, o_cubemap.m_faces[_face]);
+#if DEBUG_TOOLS
+					faceTicks[_face] = stm_since(faceStartTicks);
+#endif
+				};
+
+				std::array<std::jthread, 5> faceThreads;
+				for (usize i = 1; i < cubemapFilenames.size(); ++i)
+				{
+					faceThreads[i - 1] = std::jthread{ decodeFace, i };
+				}
+				decodeFace(0);
+			}
+#if DEBUG_TOOLS
+			o_cubemap.m_debug_decodeMs = static_cast<Vec1>(stm_ms(stm_since(startTicks)));
+			for (uint64 const ticks : faceTicks)
+			{
+				o_cubemap.m_debug_sequentialDecodeMs += static_cast<Vec1>(stm_ms(ticks));
+			}
+#endif
+
+			for (usize i = 0; i < cubemapFilenames.size(); ++i)
+			{
+				DecodedTexture const& face = o_cubemap.m_faces[i];
+				if (!facesDecoded[i])
+				{
+					kaError("Texture failed to load at path: " + cubemapFilenames[i]);
+					return false;
 				}
+				kaAssert(face.m_imageComponentCount <= 3 || !CheckRGBAForAlpha(face.m_data.get(), face.DataSize()), "cubemap cannot use alpha");
+				kaAssert(face.m_width == o_cubemap.m_faces[0].m_width && face.m_height == o_cubemap.m_faces[0].m_height, "cubemap faces must all be the same size");
+			}
+
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------
+		static TextureID RegisterCubemap
+		(
+			DecodedCubemap const& _cubemap
+		)
+		{
+			sg_image_desc imageDesc{
+				.type = SG_IMAGETYPE_CUBE,
+				.pixel_format = SG_PIXELFORMAT_RGBA8,
+				.min_filter = SG_FILTER_LINEAR,
+				.mag_filter = SG_FILTER_LINEAR,
+				.wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+				.wrap_v = SG_WRAP_CLAMP_TO_EDGE,
+				.wrap_w = SG_WRAP_CLAMP_TO_EDGE,
+				.label = _cubemap.m_path.c_str(),
+			};
+			imageDesc.width = _cubemap.m_faces[0].m_width;
+			imageDesc.height = _cubemap.m_faces[0].m_height;
+			for (usize i = 0; i < _cubemap.m_faces.size(); ++i)
+			{
+				imageDesc.data.subimage[i][0] = {
+					.ptr = _cubemap.m_faces[i].m_data.get(),
+					.size = _cubemap.m_faces[i].DataSize(),
+				};
+			}
+
+			TextureID const cubemapID = g_textures.Insert(sg_make_image(imageDesc));
+			TextureData& newTexData = g_textures[cubemapID];
+			newTexData.m_type = TextureData::Type::Cubemap;
+			newTexData.m_path = _cubemap.m_path;
+			newTexData.m_sizeInBytes = _cubemap.m_faces.size() * GetRGBA8Size(_cubemap.m_faces[0].m_width, _cubemap.m_faces[0].m_height, false);
+			g_textureIDs.emplace(_cubemap.m_path, cubemapID);
+
+			kaLog("New cubemap " + _cubemap.m_path + " loaded!");
+#if DEBUG_TOOLS
+			kaLog(std::format("Decoded cubemap faces in {:.3f}ms, against {:.3f}ms decoding them one at a time", _cubemap.m_debug_decodeMs, _cubemap.m_debug_sequentialDecodeMs));
+#endif
+			return cubemapID;
+		}
+
+		//--------------------------------------------------------------------------------
+		static TextureID FindExistingCubemap
+		(
+			std::string const& _cubemapPath
+		)
+		{
+			TextureID const textureID = FindByPath(g_textureIDs, _cubemapPath);
+			if (textureID.IsValid() && GetTexture(textureID).m_type == TextureData::Type::Cubemap)
+			{
+				return textureID;
+			}
+
+			return TextureID{};
+		}
+
+		//--------------------------------------------------------------------------------
+		ResourceLoadResult LoadCubemap
+		(
+			std::string const& _cubemapPath,
+			TextureID& o_cubemapID
+		)
+		{
+			TextureID const existingID = FindExistingCubemap(_cubemapPath);
+			if (existingID.IsValid())
+			{
+				o_cubemapID = existingID;
+				return true;
+			}
+
+			DecodedCubemap cubemap;
+			if (DecodeCubemap(_cubemapPath, cubemap))
+			{
+				o_cubemapID = RegisterCubemap(cubemap);
+				return true;
 			}
+			return false;
+		}
 
-			return ModelID{};
+		//--------------------------------------------------------------------------------
+		/// model
+		//--------------------------------------------------------------------------------
+		static ModelID FindExistingModel
+		(
+			std::string const& _modelPath
+		)
+		{
+			return FindByPath(g_modelIDs, _modelPath);
 		}
-		
+
+		//--------------------------------------------------------------------------------
+		struct MaterialTexture
+		{
+			std::string m_path;
+			TextureData::Type m_type;
+		};
+
+		struct DecodedMesh
+		{
+			MaterialData m_material;
+			absl::InlinedVector<MaterialTexture, 3> m_textures;
+			usize m_indexOffset{ 0 };
+			usize m_indexCount{ 0 };
+		};
+
+		struct DecodedModel
+		{
+			std::string m_path;
+			std::string m_directory;
+			std::vector<DecodedMesh> m_meshes;
+			std::vector<PackedVertexData> m_vertexBufferData;
+			std::vector<uint8> m_indexBufferData; // in m_indexType
+			sg_index_type m_indexType{ SG_INDEXTYPE_UINT32 };
+
+			// Material textures that were decoded alongside the model. Any not in here are loaded when the model is registered.
+			std::vector<DecodedTexture> m_textures;
+		};
+
 		//--------------------------------------------------------------------------------
-		static void LoadMaterialTextures
+		static void CollectMaterialTextures
 		(
 			std::string const& _directory,
 			aiMaterial* _mat,
-			std::vector<TextureID>& o_textures
+			absl::InlinedVector<MaterialTexture, 3>& o_textures
 		)
 		{
-			auto fn_loadTextureType = [&_directory, &_mat, &o_textures](aiTextureType _type)
+			auto fn_collectTextureType = [&_directory, &_mat, &o_textures](aiTextureType _type)
 			{
 				// TODO support more than 1 texture?
 				//for (unsigned int i = 0; i < _mat->GetTextureCount(_type); i++)
@@ -345,7 +953,7 @@ namespace Core
 					aiString str;
 					_mat->GetTexture(_type, i, &str);
 
-					std::string const filename = _directory + '/' + str.C_Str();
+					std::string filename = _directory + '/' + str.C_Str();
 
 					TextureData::Type textureType = TextureData::Type::General2D;
 					switch (_type)
@@ -372,35 +980,20 @@ namespace Core
 					}
 					}
 
-					TextureID textureID;
-					bool semitransparent{ false };
-					if (Load2DTexture(filename, textureID, textureType, &semitransparent))
-					{
-						kaAssert(textureID.IsValid());
-						kaAssert(!semitransparent, "semi-transparent textures nyi");
-						o_textures.emplace_back(textureID);
-					}
+					o_textures.push_back({ std::move(filename), textureType, });
 				}
 			};
 
-			fn_loadTextureType(aiTextureType_DIFFUSE);
-			fn_loadTextureType(aiTextureType_SPECULAR);
-			fn_loadTextureType(aiTextureType_NORMALS);
+			fn_collectTextureType(aiTextureType_DIFFUSE);
+			fn_collectTextureType(aiTextureType_SPECULAR);
+			fn_collectTextureType(aiTextureType_NORMALS);
 		}
 
 		//--------------------------------------------------------------------------------
 		struct MeshLoadData
 		{
 			std::vector<VertexData> m_vertices;
-			std::vector<IndexType> m_indices;
-		};
-
-		struct ModelLoadData
-		{
-			absl::InlinedVector<Vec1, 256> m_vertexBufferData;
-			absl::InlinedVector<uint32, 256> m_indexBufferData;
-
-			absl::InlinedVector<MeshLoadData, 64> m_meshes;
+			std::vector<uint32> m_indices;
 		};
 
 		//--------------------------------------------------------------------------------
@@ -409,7 +1002,7 @@ namespace Core
 			std::string const& _directory,
 			aiMesh* _mesh,
 			aiScene const* _scene,
-			MeshData& o_newMesh,
+			DecodedMesh& o_newMesh,
 			MeshLoadData& o_loadData
 		)
 		{
@@ -437,7 +1030,7 @@ namespace Core
 				kaAssert(face.mNumIndices == numIndicesPerFace);
 				for (usize j = 0; j < face.mNumIndices; j++)
 				{
-					o_loadData.m_indices[i * numIndicesPerFace + j] = static_cast<uint16>(face.mIndices[j]);
+					o_loadData.m_indices[i * numIndicesPerFace + j] = face.mIndices[j];
 				}
 			}
 
@@ -446,7 +1039,7 @@ namespace Core
 				aiMaterial* material = _scene->mMaterials[_mesh->mMaterialIndex];
 
 				MaterialData& newMaterial = o_newMesh.m_material;
-				LoadMaterialTextures(_directory, material, o_newMesh.m_textures);
+				CollectMaterialTextures(_directory, material, o_newMesh.m_textures);
 
 				aiColor3D colour(0.0f, 0.0f, 0.0f);
 				Vec1 shininess{ 0.0f };
@@ -463,49 +1056,14 @@ namespace Core
 				material->Get(AI_MATKEY_SHININESS, shininess);
 				newMaterial.shininess = shininess;
 			}
-
-			// now finalise by making texture bindings
-			o_newMesh.m_bindings.fs_images[SLOT_main_mat_diffuseTex] = g_defaultTextureID.GetSokolID();
-			o_newMesh.m_bindings.fs_images[SLOT_main_mat_specularTex] = g_defaultTextureID.GetSokolID();
-			o_newMesh.m_bindings.fs_images[SLOT_main_mat_normalTex] = g_defaultNormalTextureID.GetSokolID();
-			for (TextureID const& texID : o_newMesh.m_textures)
-			{
-				TextureData const& tex = GetTexture(texID);
-				switch (tex.m_type)
-				{
-					using enum TextureData::Type;
-
-				case Diffuse:
-				{
-					o_newMesh.m_bindings.fs_images[SLOT_main_mat_diffuseTex] = texID.GetSokolID();
-					break;
-				}
-				case Specular:
-				{
-					o_newMesh.m_bindings.fs_images[SLOT_main_mat_specularTex] = texID.GetSokolID();
-					break;
-				}
-				case Normal:
-				{
-					o_newMesh.m_bindings.fs_images[SLOT_main_mat_normalTex] = texID.GetSokolID();
-					break;
-				}
-				case General2D:
-				case Cubemap:
-				{
-					kaError("shouldn't have gotten this texture type in a material texture load!");
-					break;
-				}
-				}
-			}
 		}
 
 		//--------------------------------------------------------------------------------
 		static void ProcessNode
 		(
 			std::string const& _directory,
-			ModelData& io_model,
-			ModelLoadData& io_loadData,
+			DecodedModel& io_model,
+			std::vector<MeshLoadData>& io_meshLoadData,
 			aiNode* _node,
 			aiScene const* _scene
 		)
@@ -515,30 +1073,57 @@ namespace Core
 			{
 				aiMesh* mesh = _scene->mMeshes[_node->mMeshes[i]];
 				io_model.m_meshes.emplace_back();
-				io_loadData.m_meshes.emplace_back();
-				ProcessMesh(_directory, mesh, _scene, io_model.m_meshes.back(), io_loadData.m_meshes.back());
+				io_meshLoadData.emplace_back();
+				ProcessMesh(_directory, mesh, _scene, io_model.m_meshes.back(), io_meshLoadData.back());
 			}
 			// then do the same for each of its children
 			for (unsigned int i = 0; i < _node->mNumChildren; i++)
 			{
-				ProcessNode(_directory, io_model, io_loadData, _node->mChildren[i], _scene);
+				ProcessNode(_directory, io_model, io_meshLoadData, _node->mChildren[i], _scene);
 			}
 		}
 
 		//--------------------------------------------------------------------------------
-		ResourceLoadResult LoadModel
+		static usize GetIndexSize
 		(
-			std::string const& _path,
-			ModelID& o_modelID
+			sg_index_type _indexType
 		)
 		{
-			ModelID const existingID = FindExistingModel(_path);
-			if (existingID.IsValid())
+			kaAssert(_indexType == SG_INDEXTYPE_UINT16 || _indexType == SG_INDEXTYPE_UINT32);
+			return _indexType == SG_INDEXTYPE_UINT16 ? sizeof(uint16) : sizeof(uint32);
+		}
+
+		//--------------------------------------------------------------------------------
+		// Octahedral encoding of a unit vector, packed to snorm16. The vertex shader decodes it.
+		static std::array<int16, 2> OctEncodeSnorm16
+		(
+			Vec3 const& _v
+		)
+		{
+			Vec1 const l1Norm = std::abs(_v.x) + std::abs(_v.y) + std::abs(_v.z);
+			if (l1Norm <= 0.0f)
 			{
-				o_modelID = existingID;
-				return true;
+				return { 0, 0 };
+			}
+
+			Vec2 p = Vec2(_v.x, _v.y) / l1Norm;
+			if (_v.z < 0.0f)
+			{
+				Vec2 const signs{ p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f };
+				p = (1.0f - glm::abs(Vec2(p.y, p.x))) * signs;
 			}
 
+			auto const fn_toSnorm16 = [](Vec1 _f) { return static_cast<int16>(std::round(glm::clamp(_f, -1.0f, 1.0f) * 32767.0f)); };
+			return { fn_toSnorm16(p.x), fn_toSnorm16(p.y) };
+		}
+
+		//--------------------------------------------------------------------------------
+		static bool ImportModel
+		(
+			std::string const& _path,
+			DecodedModel& o_model
+		)
+		{
 			Assimp::Importer import;
 			aiScene const* scene = import.ReadFile(
 				_path
@@ -556,145 +1141,465 @@ namespace Core
 				kaError(std::string("assimp error: ") + import.GetErrorString());
 				return false;
 			}
-			std::string const directory = _path.substr(0, _path.find_last_of('/'));
-
-			o_modelID = g_models.Emplace();
-			ModelData& newModel = g_models[o_modelID];
-			ModelLoadData loadData;
-			newModel.m_path = _path;
-			ProcessNode(directory, newModel, loadData, scene->mRootNode, scene);
 
-			kaAssert(newModel.m_meshes.size() == loadData.m_meshes.size());
+			std::vector<MeshLoadData> meshLoadData;
+			ProcessNode(o_model.m_directory, o_model, meshLoadData, scene->mRootNode, scene);
 
-			// Make bindings for model
+			kaAssert(o_model.m_meshes.size() == meshLoadData.size());
 
-			// First, fill scratch data.
+			// Pack all meshes into one vertex and index buffer.
 			usize meshVertexOffset = 0;
 			usize meshIndexOffset = 0;
 			usize totalVertexCount = 0;
 			usize totalIndexCount = 0;
-			for (MeshLoadData const& meshLoadData : loadData.m_meshes)
+			for (MeshLoadData const& mesh : meshLoadData)
 			{
-				totalVertexCount += meshLoadData.m_vertices.size();
-				totalIndexCount += meshLoadData.m_indices.size();
+				totalVertexCount += mesh.m_vertices.size();
+				totalIndexCount += mesh.m_indices.size();
 			}
-			loadData.m_vertexBufferData.reserve((sizeof(Resource::VertexData)/sizeof( Vec1 )) * totalVertexCount);
-			loadData.m_indexBufferData.reserve(totalIndexCount);
-			for (usize meshI = 0; meshI < newModel.m_meshes.size(); ++meshI)
+			// Leave 0xFFFF free, as it's the primitive restart index on some backends.
+			o_model.m_indexType = totalVertexCount < std::numeric_limits<uint16>::max() ? SG_INDEXTYPE_UINT16 : SG_INDEXTYPE_UINT32;
+			usize const indexSize = GetIndexSize(o_model.m_indexType);
+
+			o_model.m_vertexBufferData.reserve(totalVertexCount);
+			o_model.m_indexBufferData.resize(totalIndexCount * indexSize);
+			uint8* nextIndex = o_model.m_indexBufferData.data();
+			for (usize meshI = 0; meshI < o_model.m_meshes.size(); ++meshI)
 			{
-				for (VertexData const& vertex : loadData.m_meshes[meshI].m_vertices)
+				for (VertexData const& vertex : meshLoadData[meshI].m_vertices)
 				{
-					loadData.m_vertexBufferData.emplace_back(vertex.position.x);
-					loadData.m_vertexBufferData.emplace_back(vertex.position.y);
-					loadData.m_vertexBufferData.emplace_back(vertex.position.z);
-					loadData.m_vertexBufferData.emplace_back(vertex.normal.x);
-					loadData.m_vertexBufferData.emplace_back(vertex.normal.y);
-					loadData.m_vertexBufferData.emplace_back(vertex.normal.z);
-					loadData.m_vertexBufferData.emplace_back(vertex.uv.x);
-					loadData.m_vertexBufferData.emplace_back(vertex.uv.y);
-					loadData.m_vertexBufferData.emplace_back(vertex.tangent.x);
-					loadData.m_vertexBufferData.emplace_back(vertex.tangent.y);
-					loadData.m_vertexBufferData.emplace_back(vertex.tangent.z);
+					o_model.m_vertexBufferData.push_back({
+						.position = vertex.position,
+						.normal = OctEncodeSnorm16(vertex.normal),
+						.uv = vertex.uv,
+						.tangent = OctEncodeSnorm16(vertex.tangent),
+					});
 				}
-				for (auto const& index : loadData.m_meshes[meshI].m_indices)
+				for (uint32 const index : meshLoadData[meshI].m_indices)
 				{
-					loadData.m_indexBufferData.push_back(static_cast<uint32>(meshVertexOffset + index));
+					uint32 const modelIndex = static_cast<uint32>(meshVertexOffset + index);
+					if (o_model.m_indexType == SG_INDEXTYPE_UINT16)
+					{
+						uint16 const narrowIndex = static_cast<uint16>(modelIndex);
+						std::memcpy(nextIndex, &narrowIndex, sizeof(narrowIndex));
+					}
+					else
+					{
+						std::memcpy(nextIndex, &modelIndex, sizeof(modelIndex));
+					}
+					nextIndex += indexSize;
 				}
-				newModel.m_meshes[meshI].m_bindings.index_buffer_offset = static_cast<int>(meshIndexOffset * sizeof(Resource::IndexType));
-				meshVertexOffset += loadData.m_meshes[meshI].m_vertices.size();
-				meshIndexOffset += loadData.m_meshes[meshI].m_indices.size();
+
+				kaAssert(meshLoadData[meshI].m_indices.size() <= INT_MAX, "Too many vertices want to be rendered in this mesh");
+				o_model.m_meshes[meshI].m_indexOffset = meshIndexOffset;
+				o_model.m_meshes[meshI].m_indexCount = meshLoadData[meshI].m_indices.size();
+				meshVertexOffset += meshLoadData[meshI].m_vertices.size();
+				meshIndexOffset += meshLoadData[meshI].m_indices.size();
 			}
 
-			// Now, create buffers and bind to all meshes
-			sg_buffer vBuf{};
-			sg_buffer iBuf{};
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------
+		/// cooked model
+		//--------------------------------------------------------------------------------
+		// The first time a model is imported, the result is cooked into a file next to it, holding the buffers exactly as they're uploaded.
+		// Later loads read that instead of going through assimp, as long as the source hasn't changed since.
+		// Bump the version whenever the file layout, vertex layout or import settings change.
+		static constexpr uint32 c_cookedModelMagic{ 'd' | ('r' << 8) | ('m' << 16) | ('c' << 24) };
+		static constexpr uint32 c_cookedModelVersion{ 2 };
+
+		struct CookedModelHeader
+		{
+			uint32 m_magic{ c_cookedModelMagic };
+			uint32 m_version{ c_cookedModelVersion };
+			int64 m_sourceWriteTime{ 0 };
+			uint64 m_numMeshes{ 0 };
+			uint64 m_numVertices{ 0 };
+			uint32 m_indexType{ 0 };
+			uint64 m_numIndexBytes{ 0 };
+		};
+
+		static_assert(std::is_trivially_copyable_v<MaterialData>);
+
+		//--------------------------------------------------------------------------------
+		static bool ReadCookedModel
+		(
+			std::string const& _path,
+			DecodedModel& o_model
+		)
+		{
+			std::optional<int64> const sourceWriteTime = GetWriteTime(_path);
+			if (!sourceWriteTime.has_value())
 			{
-				sg_buffer_desc vBufDesc{};
-				vBufDesc.type = SG_BUFFERTYPE_VERTEXBUFFER;
-				vBufDesc.data = { &loadData.m_vertexBufferData[0], loadData.m_vertexBufferData.size() * sizeof( Vec1 ), };
-#if DEBUG_TOOLS
-				newModel._traceName_vBufData = directory + "/vertices";
-				vBufDesc.label = newModel._traceName_vBufData.c_str();
-#endif
-				vBuf = sg_make_buffer(vBufDesc);
+				return false;
 			}
 
+			std::ifstream cookedFile{ GetCookedPath(_path), std::ios::binary };
+			if (!cookedFile.is_open())
 			{
-				sg_buffer_desc iBufDesc{};
-				iBufDesc.type = SG_BUFFERTYPE_INDEXBUFFER;
-				iBufDesc.data = { &loadData.m_indexBufferData[0], loadData.m_indexBufferData.size() * sizeof(Resource::IndexType), };
-#if DEBUG_TOOLS
-				newModel._traceName_iBufData = directory + "/indices";
-				iBufDesc.label = newModel._traceName_iBufData.c_str();
-#endif
-				iBuf = sg_make_buffer(iBufDesc);
+				return false;
 			}
-			for (MeshData& mesh : newModel.m_meshes)
+
+			CookedModelHeader header;
+			if (!ReadBinary(cookedFile, &header)
+				|| header.m_magic != c_cookedModelMagic
+				|| header.m_version != c_cookedModelVersion
+				|| header.m_sourceWriteTime != *sourceWriteTime)
 			{
-				mesh.m_bindings.vertex_buffers[0] = vBuf;
-				mesh.m_bindings.index_buffer = iBuf;
+				return false;
 			}
 
-			for (usize meshI = 0; meshI < newModel.m_meshes.size(); ++meshI)
+			o_model.m_meshes.resize(header.m_numMeshes);
+			for (DecodedMesh& mesh : o_model.m_meshes)
 			{
-				kaAssert(loadData.m_meshes[meshI].m_indices.size() <= INT_MAX, "Too many vertices want to be rendered in this mesh");
-				newModel.m_meshes[meshI].SetNumToDraw(static_cast<int>(loadData.m_meshes[meshI].m_indices.size()));
+				uint64 indexOffset{ 0 };
+				uint64 indexCount{ 0 };
+				uint32 numTextures{ 0 };
+				if (!ReadBinary(cookedFile, &mesh.m_material)
+					|| !ReadBinary(cookedFile, &indexOffset)
+					|| !ReadBinary(cookedFile, &indexCount)
+					|| !ReadBinary(cookedFile, &numTextures))
+				{
+					return false;
+				}
+				mesh.m_indexOffset = static_cast<usize>(indexOffset);
+				mesh.m_indexCount = static_cast<usize>(indexCount);
+
+				mesh.m_textures.resize(numTextures);
+				for (MaterialTexture& texture : mesh.m_textures)
+				{
+					uint32 type{ 0 };
+					uint32 filenameLength{ 0 };
+					if (!ReadBinary(cookedFile, &type) || !ReadBinary(cookedFile, &filenameLength))
+					{
+						return false;
+					}
+
+					// stored relative to the model, so the cooked file can move with it
+					std::string filename(filenameLength, '\0');
+					if (!ReadBinary(cookedFile, filename.data(), filename.size()))
+					{
+						return false;
+					}
+					texture.m_path = o_model.m_directory + '/' + filename;
+					texture.m_type = static_cast<TextureData::Type>(type);
+				}
 			}
 
-			// All loaded data automatically gets cleared now it's in the GPU
+			o_model.m_indexType = static_cast<sg_index_type>(header.m_indexType);
+			if (o_model.m_indexType != SG_INDEXTYPE_UINT16 && o_model.m_indexType != SG_INDEXTYPE_UINT32)
+			{
+				return false;
+			}
 
-			kaLog("New model " + _path + " loaded!");
-			return true;
+			o_model.m_vertexBufferData.resize(header.m_numVertices);
+			o_model.m_indexBufferData.resize(header.m_numIndexBytes);
+			return ReadBinary(cookedFile, o_model.m_vertexBufferData.data(), o_model.m_vertexBufferData.size())
+				&& ReadBinary(cookedFile, o_model.m_indexBufferData.data(), o_model.m_indexBufferData.size());
 		}
 
-		ResourceLoadResult LoadCubemap
+		//--------------------------------------------------------------------------------
+		static void WriteCookedModel
 		(
-			std::string const& _cubemapPath,
-			TextureID& o_cubemapID
+			DecodedModel const& _model
 		)
 		{
-			for (auto const& [texID, texData] : g_textures)
+			std::optional<int64> const sourceWriteTime = GetWriteTime(_model.m_path);
+			if (!sourceWriteTime.has_value())
 			{
-				if (texData.m_type == TextureData::Type::Cubemap && texData.m_path == _cubemapPath)
-				{
-					o_cubemapID = texID;
-					return true;
-				}
+				return;
 			}
 
-			sg_image newImageID{};
-			if (LoadCubemapFromFile(_cubemapPath, newImageID))
+			std::string const cookedPath = GetCookedPath(_model.m_path);
+			std::string const tempPath = GetCookedTempPath(cookedPath);
+			std::ofstream cookedFile{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!cookedFile.is_open())
 			{
-				o_cubemapID = g_textures.Insert(newImageID);
-				TextureData& newTexData = g_textures[o_cubemapID];
-				newTexData.m_type = TextureData::Type::Cubemap;
-				newTexData.m_path = _cubemapPath;
+				return;
+			}
 
-				kaLog("New cubemap " + _cubemapPath + " loaded!");
-				return true;
+			CookedModelHeader const header{
+				.m_sourceWriteTime = *sourceWriteTime,
+				.m_numMeshes = _model.m_meshes.size(),
+				.m_numVertices = _model.m_vertexBufferData.size(),
+				.m_indexType = static_cast<uint32>(_model.m_indexType),
+				.m_numIndexBytes = _model.m_indexBufferData.size(),
+			};
+			WriteBinary(cookedFile, &header);
+
+			for (DecodedMesh const& mesh : _model.m_meshes)
+			{
+				uint64 const indexOffset = mesh.m_indexOffset;
+				uint64 const indexCount = mesh.m_indexCount;
+				uint32 const numTextures = static_cast<uint32>(mesh.m_textures.size());
+				WriteBinary(cookedFile, &mesh.m_material);
+				WriteBinary(cookedFile, &indexOffset);
+				WriteBinary(cookedFile, &indexCount);
+				WriteBinary(cookedFile, &numTextures);
+
+				for (MaterialTexture const& texture : mesh.m_textures)
+				{
+					kaAssert(texture.m_path.starts_with(_model.m_directory + '/'));
+					std::string_view const filename = std::string_view(texture.m_path).substr(_model.m_directory.size() + 1);
+					uint32 const type = static_cast<uint32>(texture.m_type);
+					uint32 const filenameLength = static_cast<uint32>(filename.size());
+					WriteBinary(cookedFile, &type);
+					WriteBinary(cookedFile, &filenameLength);
+					WriteBinary(cookedFile, filename.data(), filename.size());
+				}
 			}
-			return false;
-		}
 
+			WriteBinary(cookedFile, _model.m_vertexBufferData.data(), _model.m_vertexBufferData.size());
+			WriteBinary(cookedFile, _model.m_indexBufferData.data(), _model.m_indexBufferData.size());
+
+			CommitCookedFile(cookedFile, tempPath, cookedPath);
+		}
 
 		//--------------------------------------------------------------------------------
-		/// sprite
-		//--------------------------------------------------------------------------------
-		ResourceLoadResult LoadSprite
+		static bool DecodeModel
 		(
 			std::string const& _path,
-			SpriteID& o_spriteID
+			bool _decodeTextures,
+			DecodedModel& o_model
 		)
 		{
-			for (auto const& [spriteID, sprite] : g_sprites)
+			o_model.m_path = _path;
+			o_model.m_directory = _path.substr(0, _path.find_last_of('/'));
+
+			if (!ReadCookedModel(_path, o_model))
 			{
-				if (sprite.m_path == _path)
+				o_model.m_meshes.clear();
+				o_model.m_vertexBufferData.clear();
+				o_model.m_indexBufferData.clear();
+
+				if (!ImportModel(_path, o_model))
 				{
-					o_spriteID = spriteID;
-					return true;
+					return false;
+				}
+				WriteCookedModel(o_model);
+			}
+
+			if (_decodeTextures)
+			{
+				for (DecodedMesh const& mesh : o_model.m_meshes)
+				{
+					for (MaterialTexture const& materialTexture : mesh.m_textures)
+					{
+						bool const alreadyDecoded = std::ranges::any_of(o_model.m_textures, [&](DecodedTexture const& _tex) { return _tex.m_path == materialTexture.m_path; });
+						if (!alreadyDecoded)
+						{
+							DecodedTexture& texture = o_model.m_textures.emplace_back();
+							if (!DecodeTexture(materialTexture.m_path, UseCompressedTexture(materialTexture.m_type), texture))
+							{
+								// leave it to the register step to report
+								o_model.m_textures.pop_back();
+							}
+						}
+					}
 				}
 			}
 
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------
+		// Centred on the bounding box, which is close enough to the smallest sphere for culling.
+		static Vec4 CalculateBoundingSphere
+		(
+			std::vector<PackedVertexData> const& _vertices
+		)
+		{
+			if (_vertices.empty())
+			{
+				return Vec4{};
+			}
+
+			Vec3 boundsMin{ _vertices[0].position };
+			Vec3 boundsMax{ _vertices[0].position };
+			for (PackedVertexData const& vertex : _vertices)
+			{
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+			}
+
+			Vec3 const centre = (boundsMin + boundsMax) * 0.5f;
+			Vec1 radiusSq{ 0.0f };
+			for (PackedVertexData const& vertex : _vertices)
+			{
+				Vec3 const offset = vertex.position - centre;
+				radiusSq = std::max(radiusSq, glm::dot(offset, offset));
+			}
+			return Vec4{ centre, std::sqrt(radiusSq) };
+		}
+
+		//--------------------------------------------------------------------------------
+		static ModelID RegisterModel
+		(
+			DecodedModel const& _model
+		)
+		{
+			ModelID const modelID = g_models.Emplace();
+			ModelData& newModel = g_models[modelID];
+			newModel.m_path = _model.m_path;
+			newModel.m_indexType = _model.m_indexType;
+			newModel.m_boundingSphere = CalculateBoundingSphere(_model.m_vertexBufferData);
+			g_modelIDs.emplace(_model.m_path, modelID);
+
+			// Create buffers to bind to all meshes
+			sg_buffer vBuf{};
+			sg_buffer iBuf{};
+			{
+				sg_buffer_desc vBufDesc{};
+				vBufDesc.type = SG_BUFFERTYPE_VERTEXBUFFER;
+				vBufDesc.data = { _model.m_vertexBufferData.data(), _model.m_vertexBufferData.size() * sizeof( PackedVertexData ), };
+#if DEBUG_TOOLS
+				newModel._traceName_vBufData = _model.m_directory + "/vertices";
+				vBufDesc.label = newModel._traceName_vBufData.c_str();
+#endif
+				vBuf = sg_make_buffer(vBufDesc);
+			}
+
+			{
+				sg_buffer_desc iBufDesc{};
+				iBufDesc.type = SG_BUFFERTYPE_INDEXBUFFER;
+				iBufDesc.data = { _model.m_indexBufferData.data(), _model.m_indexBufferData.size(), };
+#if DEBUG_TOOLS
+				newModel._traceName_iBufData = _model.m_directory + "/indices";
+				iBufDesc.label = newModel._traceName_iBufData.c_str();
+#endif
+				iBuf = sg_make_buffer(iBufDesc);
+			}
+
+			newModel.m_meshes.resize(_model.m_meshes.size());
+			for (usize meshI = 0; meshI < _model.m_meshes.size(); ++meshI)
+			{
+				DecodedMesh const& decodedMesh = _model.m_meshes[meshI];
+				MeshData& mesh = newModel.m_meshes[meshI];
+				mesh.m_material = decodedMesh.m_material;
+
+				for (MaterialTexture const& materialTexture : decodedMesh.m_textures)
+				{
+					auto const decodedTexture = std::ranges::find(_model.m_textures, materialTexture.m_path, &DecodedTexture::m_path);
+
+					TextureID textureID;
+					bool semitransparent{ false };
+					if (decodedTexture != _model.m_textures.end())
+					{
+						textureID = FindOrRegisterTexture(*decodedTexture, materialTexture.m_type);
+						semitransparent = decodedTexture->m_semitransparent;
+					}
+					else if (!Load2DTexture(materialTexture.m_path, textureID, materialTexture.m_type, &semitransparent))
+					{
+						continue;
+					}
+
+					kaAssert(textureID.IsValid());
+					kaAssert(!semitransparent, "semi-transparent textures nyi");
+					mesh.m_textures.emplace_back(textureID);
+				}
+
+				// now finalise by making texture bindings
+				mesh.m_bindings.fs_images[SLOT_main_mat_diffuseTex] = g_defaultTextureID.GetSokolID();
+				mesh.m_bindings.fs_images[SLOT_main_mat_specularTex] = g_defaultTextureID.GetSokolID();
+				mesh.m_bindings.fs_images[SLOT_main_mat_normalTex] = g_defaultNormalTextureID.GetSokolID();
+				for (TextureID const& texID : mesh.m_textures)
+				{
+					TextureData const& tex = GetTexture(texID);
+					switch (tex.m_type)
+					{
+						using enum TextureData::Type;
+
+					case Diffuse:
+					{
+						mesh.m_bindings.fs_images[SLOT_main_mat_diffuseTex] = texID.GetSokolID();
+						break;
+					}
+					case Specular:
+					{
+						mesh.m_bindings.fs_images[SLOT_main_mat_specularTex] = texID.GetSokolID();
+						break;
+					}
+					case Normal:
+					{
+						mesh.m_bindings.fs_images[SLOT_main_mat_normalTex] = texID.GetSokolID();
+						break;
+					}
+					case General2D:
+					case Cubemap:
+					{
+						kaError("shouldn't have gotten this texture type in a material texture load!");
+						break;
+					}
+					}
+				}
+
+				mesh.m_bindings.vertex_buffers[0] = vBuf;
+				mesh.m_bindings.index_buffer = iBuf;
+				mesh.m_bindings.index_buffer_offset = static_cast<int>(decodedMesh.m_indexOffset * GetIndexSize(_model.m_indexType));
+				mesh.SetNumToDraw(static_cast<int>(decodedMesh.m_indexCount));
+			}
+
+			kaLog("New model " + _model.m_path + " loaded!");
+			return modelID;
+		}
+
+		//--------------------------------------------------------------------------------
+		ResourceLoadResult LoadModel
+		(
+			std::string const& _path,
+			ModelID& o_modelID
+		)
+		{
+			ModelID const existingID = FindExistingModel(_path);
+			if (existingID.IsValid())
+			{
+				o_modelID = existingID;
+				return true;
+			}
+
+			// Textures get loaded as they're registered, so any already loaded are shared.
+			DecodedModel model;
+			if (!DecodeModel(_path, false, model))
+			{
+				return false;
+			}
+
+			o_modelID = RegisterModel(model);
+			return true;
+		}
+
+
+		//--------------------------------------------------------------------------------
+		/// sprite
+		//--------------------------------------------------------------------------------
+		struct DecodedSprite
+		{
+			std::string m_path;
+			std::string m_texturePath;
+			std::optional<DecodedTexture> m_texture;
+			Vec2 m_dimensions;
+			Vec2 m_topLeft;
+			bool m_useAlpha{ false };
+		};
+
+		//--------------------------------------------------------------------------------
+		static SpriteID FindExistingSprite
+		(
+			std::string const& _path
+		)
+		{
+			return FindByPath(g_spriteIDs, _path);
+		}
+
+		//--------------------------------------------------------------------------------
+		static bool DecodeSprite
+		(
+			std::string const& _path,
+			bool _decodeTexture,
+			DecodedSprite& o_sprite
+		)
+		{
 			std::ifstream spriteFile{ _path };
 			if (!spriteFile.is_open())
 			{
@@ -704,29 +1609,14 @@ namespace Core
 
 			std::string const directory = _path.substr(0, _path.find_last_of('/') + 1);
 
-			o_spriteID = g_sprites.Emplace();
-			SpriteData& newSprite = g_sprites[ o_spriteID ];
-			newSprite.m_path = _path;
+			o_sprite.m_path = _path;
 
 			std::string line;
 
 			// line 1: texture file
-			Vec1 textureWidth{ 1 };
-			Vec1 textureHeight{ 1 };
 			if (std::getline(spriteFile, line))
 			{
-				std::string const texturePath = directory + line;
-				TextureID textureID;
-				if (Load2DTexture(texturePath, textureID, TextureData::Type::General2D))
-				{
-					kaAssert(textureID.IsValid());
-
-					TextureData const& textureData = GetTexture(textureID);
-
-					newSprite.m_texture = textureID;
-					textureWidth = static_cast< Vec1 >(textureData.m_width);
-					textureHeight = static_cast< Vec1 >(textureData.m_height);
-				}
+				o_sprite.m_texturePath = directory + line;
 			}
 			else
 			{
@@ -740,7 +1630,7 @@ namespace Core
 				usize const mid = line.find_first_of(' ');
 				Vec1 const width = static_cast< Vec1 >(std::atof(line.substr(0, mid).c_str()));
 				Vec1 const height = static_cast< Vec1 >(std::atof(line.substr(mid + 1).c_str()));
-				newSprite.m_dimensions = { width, height };
+				o_sprite.m_dimensions = { width, height };
 			}
 			else
 			{
@@ -755,36 +1645,356 @@ namespace Core
 				usize const mid = line.find_first_of(' ');
 				Vec1 const x = static_cast< Vec1 >(std::atof(line.substr(0, mid).c_str()));
 				Vec1 const y = static_cast< Vec1 >(std::atof(line.substr(mid + 1).c_str()));
-				newSprite.m_topLeftUV = { x, y };
+				o_sprite.m_topLeft = { x, y };
 			}
 			else
 			{
 				kaError("sprite file missing top-left UV");
 				return false;
 			}
-			
+
 			// line 4: alpha
 			if ( std::getline( spriteFile, line ) )
 			{
 				if ( line == "alpha" )
 				{
-					newSprite.m_useAlpha = true;
+					o_sprite.m_useAlpha = true;
 				}
 			}
 
+			if (_decodeTexture)
+			{
+				o_sprite.m_texture.emplace();
+				if (!DecodeTexture(o_sprite.m_texturePath, false, *o_sprite.m_texture))
+				{
+					// leave it to the register step to report
+					o_sprite.m_texture.reset();
+				}
+			}
+
+			return true;
+		}
+
+		//--------------------------------------------------------------------------------
+		static void AddSpriteAtlasCandidate(TextureID _texture, DecodedTexture&& _decoded);
+
+		static SpriteID RegisterSprite
+		(
+			DecodedSprite&& _sprite
+		)
+		{
+			SpriteID const spriteID = g_sprites.Emplace();
+			SpriteData& newSprite = g_sprites[ spriteID ];
+			newSprite.m_path = _sprite.m_path;
+			g_spriteIDs.emplace(_sprite.m_path, spriteID);
+
+			Vec1 textureWidth{ 1 };
+			Vec1 textureHeight{ 1 };
+			TextureID textureID;
+			if (_sprite.m_texture.has_value())
+			{
+				textureID = FindExistingTexture(_sprite.m_texturePath);
+				if (!textureID.IsValid())
+				{
+					textureID = RegisterTexture(*_sprite.m_texture, TextureData::Type::General2D);
+					AddSpriteAtlasCandidate(textureID, std::move(*_sprite.m_texture));
+				}
+			}
+			else if (!Load2DTexture(_sprite.m_texturePath, textureID, TextureData::Type::General2D))
+			{
+				textureID = TextureID{};
+			}
+
+			if (textureID.IsValid())
+			{
+				TextureData const& textureData = GetTexture(textureID);
+
+				newSprite.m_texture = textureID;
+				textureWidth = static_cast< Vec1 >(textureData.m_width);
+				textureHeight = static_cast< Vec1 >(textureData.m_height);
+			}
+
+			newSprite.m_dimensions = _sprite.m_dimensions;
+			newSprite.m_topLeftUV = _sprite.m_topLeft;
+			newSprite.m_useAlpha = _sprite.m_useAlpha;
+
 			newSprite.m_dimensionsUV = newSprite.m_dimensions;
 			newSprite.m_dimensionsUV.x /= textureWidth;
 			newSprite.m_dimensionsUV.y /= textureHeight;
 			newSprite.m_topLeftUV.x /= textureWidth;
 			newSprite.m_topLeftUV.y /= textureHeight;
 
-			kaLog("New sprite " + _path + " loaded!");
+			kaLog("New sprite " + _sprite.m_path + " loaded!");
+			return spriteID;
+		}
+
+		//--------------------------------------------------------------------------------
+		ResourceLoadResult LoadSprite
+		(
+			std::string const& _path,
+			SpriteID& o_spriteID
+		)
+		{
+			SpriteID const existingID = FindExistingSprite(_path);
+			if (existingID.IsValid())
+			{
+				o_spriteID = existingID;
+				return true;
+			}
+
+			DecodedSprite sprite;
+			if (!DecodeSprite(_path, false, sprite))
+			{
+				return false;
+			}
+
+			// Decode the texture here rather than letting Load2DTexture do it, so it can be packed into an atlas.
+			if (!FindExistingTexture(sprite.m_texturePath).IsValid())
+			{
+				sprite.m_texture.emplace();
+				if (!DecodeTexture(sprite.m_texturePath, false, *sprite.m_texture))
+				{
+					sprite.m_texture.reset();
+				}
+			}
+
+			o_spriteID = RegisterSprite(std::move(sprite));
 			return true;
 		}
 
 
+		//--------------------------------------------------------------------------------
+		/// sprite atlas
+		//--------------------------------------------------------------------------------
+		// Textures first loaded by sprites keep their pixels on the CPU until PackSpriteAtlases packs them into shared pages.
+		// The sprites are then pointed at the pages, so sprites that used different textures can share draw calls.
+		static constexpr int c_atlasPageSize{ 2048 };
+		static constexpr int c_maxAtlasedTextureSize{ 512 };
+		static constexpr int c_atlasPadding{ 2 }; // edge pixels are extended into the padding, so bilinear filtering doesn't bleed between neighbours
+
+		struct SpriteAtlasCandidate
+		{
+			TextureID m_texture;
+			DecodedTexture m_decoded;
+		};
+
+		struct SpriteAtlasPlacement
+		{
+			usize m_page{ 0 };
+			int m_x{ 0 };
+			int m_y{ 0 };
+		};
+
+		static std::vector<SpriteAtlasCandidate> g_spriteAtlasCandidates;
+		static usize g_numSpriteAtlasPages{ 0 };
+
+		//--------------------------------------------------------------------------------
+		static void AddSpriteAtlasCandidate
+		(
+			TextureID _texture,
+			DecodedTexture&& _decoded
+		)
+		{
+			if (_decoded.m_data != nullptr && _decoded.m_width <= c_maxAtlasedTextureSize && _decoded.m_height <= c_maxAtlasedTextureSize)
+			{
+				g_spriteAtlasCandidates.push_back({ _texture, std::move(_decoded), });
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void BlitToAtlasPage
+		(
+			DecodedTexture const& _texture,
+			SpriteAtlasPlacement const& _placement,
+			std::vector<uint8>& io_page
+		)
+		{
+			constexpr usize pixelSize = DecodedTexture::c_dataComponentCount;
+			uint8 const* const src = _texture.m_data.get();
+			for (int row = -c_atlasPadding; row < _texture.m_height + c_atlasPadding; ++row)
+			{
+				int const srcRow = std::clamp(row, 0, _texture.m_height - 1);
+				uint8* dst = &io_page[(static_cast<usize>(_placement.m_y + row) * c_atlasPageSize + static_cast<usize>(_placement.m_x - c_atlasPadding)) * pixelSize];
+				for (int col = -c_atlasPadding; col < _texture.m_width + c_atlasPadding; ++col)
+				{
+					int const srcCol = std::clamp(col, 0, _texture.m_width - 1);
+					std::memcpy(dst, &src[(static_cast<usize>(srcRow) * _texture.m_width + srcCol) * pixelSize], pixelSize);
+					dst += pixelSize;
+				}
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		void PackSpriteAtlases()
+		{
+			if (g_spriteAtlasCandidates.empty())
+			{
+				return;
+			}
+
+			// Shelf packing, tallest first.
+			std::ranges::sort(g_spriteAtlasCandidates, std::greater{}, [](SpriteAtlasCandidate const& _c) { return _c.m_decoded.m_height; });
+
+			std::vector<SpriteAtlasPlacement> placements(g_spriteAtlasCandidates.size());
+			std::vector<usize> numPerPage{ 0 };
+			{
+				int shelfX{ 0 };
+				int shelfY{ 0 };
+				int shelfHeight{ 0 };
+				for (usize i = 0; i < g_spriteAtlasCandidates.size(); ++i)
+				{
+					int const paddedWidth = g_spriteAtlasCandidates[i].m_decoded.m_width + 2 * c_atlasPadding;
+					int const paddedHeight = g_spriteAtlasCandidates[i].m_decoded.m_height + 2 * c_atlasPadding;
+					if (shelfX + paddedWidth > c_atlasPageSize)
+					{
+						shelfY += shelfHeight;
+						shelfX = 0;
+						shelfHeight = 0;
+					}
+					if (shelfY + paddedHeight > c_atlasPageSize)
+					{
+						numPerPage.push_back(0);
+						shelfX = 0;
+						shelfY = 0;
+						shelfHeight = 0;
+					}
+
+					placements[i] = { numPerPage.size() - 1, shelfX + c_atlasPadding, shelfY + c_atlasPadding, };
+					++numPerPage.back();
+					shelfX += paddedWidth;
+					shelfHeight = std::max(shelfHeight, paddedHeight);
+				}
+			}
+
+			// Fill and create each page. A page of one texture saves nothing, so those are left alone.
+			std::vector<TextureID> pageTextures(numPerPage.size());
+			std::vector<uint8> pageData;
+			usize numPacked{ 0 };
+			for (usize page = 0; page < numPerPage.size(); ++page)
+			{
+				if (numPerPage[page] < 2)
+				{
+					continue;
+				}
+
+				pageData.assign(static_cast<usize>(c_atlasPageSize) * c_atlasPageSize * DecodedTexture::c_dataComponentCount, 0);
+				for (usize i = 0; i < g_spriteAtlasCandidates.size(); ++i)
+				{
+					if (placements[i].m_page == page)
+					{
+						BlitToAtlasPage(g_spriteAtlasCandidates[i].m_decoded, placements[i], pageData);
+					}
+				}
+
+				// No mips: each level halves the padding, so from level 2 down neighbours bleed into each other. Sprites are drawn close to native size, so little is lost.
+				std::string const pagePath = "sprite-atlas/" + std::to_string(g_numSpriteAtlasPages++);
+				sg_image_desc imageDesc{
+					.generate_mipmaps = false,
+					.pixel_format = SG_PIXELFORMAT_RGBA8,
+					.min_filter = SG_FILTER_LINEAR,
+					.mag_filter = SG_FILTER_LINEAR,
+					.wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+					.wrap_v = SG_WRAP_CLAMP_TO_EDGE,
+					.label = pagePath.c_str(),
+				};
+				imageDesc.width = c_atlasPageSize;
+				imageDesc.height = c_atlasPageSize;
+				imageDesc.data.subimage[0][0] = {
+					.ptr = pageData.data(),
+					.size = pageData.size(),
+				};
+
+				pageTextures[page] = g_textures.Insert(sg_make_image(imageDesc));
+				TextureData& pageTextureData = g_textures[pageTextures[page]];
+				pageTextureData.m_path = pagePath;
+				pageTextureData.m_type = TextureData::Type::General2D;
+				pageTextureData.m_width = c_atlasPageSize;
+				pageTextureData.m_height = c_atlasPageSize;
+				pageTextureData.m_sizeInBytes = GetRGBA8Size(c_atlasPageSize, c_atlasPageSize, false);
+				g_textureIDs.emplace(pagePath, pageTextures[page]);
+
+				numPacked += numPerPage[page];
+			}
+
+			// Point sprites at the pages. The original textures stay loaded, for anything using them directly.
+			absl::flat_hash_map<TextureID::SokolCoreType, usize> candidateIndices;
+			for (usize i = 0; i < g_spriteAtlasCandidates.size(); ++i)
+			{
+				if (pageTextures[placements[i].m_page].IsValid())
+				{
+					candidateIndices.emplace(g_spriteAtlasCandidates[i].m_texture.GetValue(), i);
+				}
+			}
+
+			for (auto [spriteID, sprite] : g_sprites)
+			{
+				auto const candidateI = candidateIndices.find(sprite.m_texture.GetValue());
+				if (candidateI == candidateIndices.end())
+				{
+					continue;
+				}
+
+				DecodedTexture const& decoded = g_spriteAtlasCandidates[candidateI->second].m_decoded;
+				SpriteAtlasPlacement const& placement = placements[candidateI->second];
+				Vec2 const textureSize{ static_cast<Vec1>(decoded.m_width), static_cast<Vec1>(decoded.m_height) };
+				Vec2 const offset{ static_cast<Vec1>(placement.m_x), static_cast<Vec1>(placement.m_y) };
+				Vec1 const pageSize = static_cast<Vec1>(c_atlasPageSize);
+
+				sprite.m_texture = pageTextures[placement.m_page];
+				sprite.m_topLeftUV = (offset + sprite.m_topLeftUV * textureSize) / pageSize;
+				sprite.m_dimensionsUV = sprite.m_dimensionsUV * textureSize / pageSize;
+			}
+
+			kaLog(std::format("Packed {:d} sprite textures into atlas pages, {:d} left unpacked", numPacked, g_spriteAtlasCandidates.size() - numPacked));
+			g_spriteAtlasCandidates.clear();
+		}
+
+
 		//--------------------------------------------------------------------------------
 		/// sound
+		//--------------------------------------------------------------------------------
+		struct DecodedSoundEffect
+		{
+			std::string m_path;
+			Sound::SoundEffect m_sound;
+		};
+
+		//--------------------------------------------------------------------------------
+		static SoundEffectID FindExistingSoundEffect
+		(
+			std::string const& _path
+		)
+		{
+			return FindByPath(g_soundEffectIDs, _path);
+		}
+
+		//--------------------------------------------------------------------------------
+		static bool DecodeSoundEffect
+		(
+			std::string const& _path,
+			DecodedSoundEffect& o_soundEffect
+		)
+		{
+			o_soundEffect.m_path = _path;
+			return o_soundEffect.m_sound.load(_path.c_str()) == SoLoud::SO_NO_ERROR;
+		}
+
+		//--------------------------------------------------------------------------------
+		static SoundEffectID RegisterSoundEffect
+		(
+			DecodedSoundEffect&& _soundEffect
+		)
+		{
+			SoundEffectID const soundEffectID = g_soundEffects.Emplace();
+			SoundEffectData& newSoundEffect = g_soundEffects[ soundEffectID ];
+			newSoundEffect.m_path = std::move(_soundEffect.m_path);
+			newSoundEffect.m_sound = std::move(_soundEffect.m_sound);
+			g_soundEffectIDs.emplace(newSoundEffect.m_path, soundEffectID);
+
+			kaLog("New sfx " + newSoundEffect.m_path + " loaded!");
+			return soundEffectID;
+		}
+
 		//--------------------------------------------------------------------------------
 		ResourceLoadResult LoadSoundEffect
 		(
@@ -792,22 +2002,17 @@ namespace Core
 			SoundEffectID& o_soundEffectID
 		)
 		{
-			for ( auto const& [soundEffectID, soundEffect] : g_soundEffects )
+			SoundEffectID const existingID = FindExistingSoundEffect(_path);
+			if (existingID.IsValid())
 			{
-				if (soundEffect.m_path == _path)
-				{
-					o_soundEffectID = soundEffectID;
-					return true;
-				}
+				o_soundEffectID = existingID;
+				return true;
 			}
 
-			o_soundEffectID = g_soundEffects.Emplace();
-			SoundEffectData& newSoundEffect = g_soundEffects[ o_soundEffectID ];
-			if (newSoundEffect.m_sound.load(_path.c_str()) == SoLoud::SO_NO_ERROR)
+			DecodedSoundEffect soundEffect;
+			if (DecodeSoundEffect(_path, soundEffect))
 			{
-				newSoundEffect.m_path = _path;
-
-				kaLog("New sfx " + _path + " loaded!");
+				o_soundEffectID = RegisterSoundEffect(std::move(soundEffect));
 				return true;
 			}
 			return false;
@@ -820,13 +2025,11 @@ namespace Core
 			MusicID& o_musicID
 		)
 		{
-			for ( auto const& [musicID, music] : g_music )
+			MusicID const existingID = FindByPath(g_musicIDs, _path);
+			if (existingID.IsValid())
 			{
-				if (music.m_path == _path)
-				{
-					o_musicID = musicID;
-					return true;
-				}
+				o_musicID = existingID;
+				return true;
 			}
 
 			o_musicID = g_music.Emplace();
@@ -834,6 +2037,7 @@ namespace Core
 			if (newMusic.m_music.load(_path.c_str()) == SoLoud::SO_NO_ERROR)
 			{
 				newMusic.m_path = _path;
+				g_musicIDs.emplace(_path, o_musicID);
 
 				kaLog("New bgm " + _path + " loaded!");
 				return true;
@@ -841,5 +2045,249 @@ namespace Core
 			return false;
 		}
 
-}
+
+		//--------------------------------------------------------------------------------
+		/// async loading
+		//--------------------------------------------------------------------------------
+		struct AsyncLoad
+		{
+			std::string m_path;
+			FileType m_type;
+			bool m_decoded{ false };
+			std::variant<std::monostate, DecodedTexture, DecodedCubemap, DecodedModel, DecodedSprite, DecodedSoundEffect> m_data;
+		};
+
+		struct AsyncLoadQueue
+		{
+			absl::Mutex m_mutex;
+			std::deque<std::unique_ptr<AsyncLoad>> m_toDecode;
+			std::deque<std::unique_ptr<AsyncLoad>> m_decoded;
+			bool m_stopping{ false };
+		};
+
+		static AsyncLoadQueue g_asyncLoads;
+		static std::vector<std::jthread> g_loadingThreads;
+		static usize g_numAsyncLoadsInFlight{ 0 }; // main thread only
+
+		//--------------------------------------------------------------------------------
+		static void DecodeAsyncLoad
+		(
+			AsyncLoad& io_load
+		)
+		{
+			Core::Profiling::Scope const profileScope{ "DecodeAsyncLoad" };
+			switch (io_load.m_type)
+			{
+				using enum FileType;
+
+			case Model:
+			{
+				io_load.m_decoded = DecodeModel(io_load.m_path, true, io_load.m_data.emplace<DecodedModel>());
+				break;
+			}
+			case Texture2D:
+			{
+				io_load.m_decoded = DecodeTexture(io_load.m_path, UseCompressedTexture(TextureData::Type::General2D), io_load.m_data.emplace<DecodedTexture>());
+				break;
+			}
+			case Cubemap:
+			{
+				io_load.m_decoded = DecodeCubemap(io_load.m_path, io_load.m_data.emplace<DecodedCubemap>());
+				break;
+			}
+			case Sprite:
+			{
+				io_load.m_decoded = DecodeSprite(io_load.m_path, true, io_load.m_data.emplace<DecodedSprite>());
+				break;
+			}
+			case SFX:
+			{
+				io_load.m_decoded = DecodeSoundEffect(io_load.m_path, io_load.m_data.emplace<DecodedSoundEffect>());
+				break;
+			}
+			case BGM:
+			{
+				// music streams, so loading only opens the file. Leave it all to the main thread.
+				io_load.m_decoded = true;
+				break;
+			}
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void FinishAsyncLoad
+		(
+			AsyncLoad& io_load
+		)
+		{
+			if (!io_load.m_decoded)
+			{
+				kaError("Failed to load " + io_load.m_path);
+				return;
+			}
+
+			// Anything loaded synchronously in the meantime wins, and the decoded data is dropped.
+			switch (io_load.m_type)
+			{
+				using enum FileType;
+
+			case Model:
+			{
+				if (!FindExistingModel(io_load.m_path).IsValid())
+				{
+					RegisterModel(std::get<DecodedModel>(io_load.m_data));
+				}
+				break;
+			}
+			case Texture2D:
+			{
+				FindOrRegisterTexture(std::get<DecodedTexture>(io_load.m_data), TextureData::Type::General2D);
+				break;
+			}
+			case Cubemap:
+			{
+				if (!FindExistingCubemap(io_load.m_path).IsValid())
+				{
+					RegisterCubemap(std::get<DecodedCubemap>(io_load.m_data));
+				}
+				break;
+			}
+			case Sprite:
+			{
+				if (!FindExistingSprite(io_load.m_path).IsValid())
+				{
+					RegisterSprite(std::move(std::get<DecodedSprite>(io_load.m_data)));
+				}
+				break;
+			}
+			case SFX:
+			{
+				if (!FindExistingSoundEffect(io_load.m_path).IsValid())
+				{
+					RegisterSoundEffect(std::move(std::get<DecodedSoundEffect>(io_load.m_data)));
+				}
+				break;
+			}
+			case BGM:
+			{
+				MusicID musicID;
+				if (!LoadMusic(io_load.m_path, musicID))
+				{
+					kaError("Failed to load " + io_load.m_path);
+				}
+				break;
+			}
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void LoadingThread()
+		{
+			auto const hasWork = [](AsyncLoadQueue* _queue) { return _queue->m_stopping || !_queue->m_toDecode.empty(); };
+
+			while (true)
+			{
+				std::unique_ptr<AsyncLoad> load;
+				{
+					absl::MutexLock lock(&g_asyncLoads.m_mutex);
+					g_asyncLoads.m_mutex.Await(absl::Condition(+hasWork, &g_asyncLoads));
+					if (g_asyncLoads.m_stopping)
+					{
+						return;
+					}
+					load = std::move(g_asyncLoads.m_toDecode.front());
+					g_asyncLoads.m_toDecode.pop_front();
+				}
+
+				DecodeAsyncLoad(*load);
+
+				{
+					absl::MutexLock lock(&g_asyncLoads.m_mutex);
+					g_asyncLoads.m_decoded.push_back(std::move(load));
+				}
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void StartLoadingThreads()
+		{
+			// Leave a core for the main thread. The loading threads sleep when there's nothing queued.
+			usize const numThreads = std::clamp<usize>(std::thread::hardware_concurrency(), 2, 9) - 1;
+			for (usize i = 0; i < numThreads; ++i)
+			{
+				g_loadingThreads.emplace_back(LoadingThread);
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		static void StopLoadingThreads()
+		{
+			{
+				absl::MutexLock lock(&g_asyncLoads.m_mutex);
+				g_asyncLoads.m_stopping = true;
+			}
+			g_loadingThreads.clear();
+
+			g_asyncLoads.m_toDecode.clear();
+			g_asyncLoads.m_decoded.clear();
+			g_numAsyncLoadsInFlight = 0;
+		}
+
+		//--------------------------------------------------------------------------------
+		void QueueAsyncLoad
+		(
+			std::string const& _path,
+			FileType _type
+		)
+		{
+			kaMainThreadAssert(!g_loadingThreads.empty(), "Resource::Init hasn't been called");
+
+			auto load = std::make_unique<AsyncLoad>();
+			load->m_path = _path;
+			load->m_type = _type;
+			{
+				absl::MutexLock lock(&g_asyncLoads.m_mutex);
+				g_asyncLoads.m_toDecode.push_back(std::move(load));
+			}
+			++g_numAsyncLoadsInFlight;
+		}
+
+		//--------------------------------------------------------------------------------
+		usize FinishAsyncLoads
+		(
+			Vec1 _budgetMs
+		)
+		{
+			kaMainThreadAssert(!g_loadingThreads.empty(), "Resource::Init hasn't been called");
+
+			uint64 const startTicks = stm_now();
+			usize numFinished = 0;
+			do
+			{
+				std::unique_ptr<AsyncLoad> load;
+				{
+					absl::MutexLock lock(&g_asyncLoads.m_mutex);
+					if (g_asyncLoads.m_decoded.empty())
+					{
+						break;
+					}
+					load = std::move(g_asyncLoads.m_decoded.front());
+					g_asyncLoads.m_decoded.pop_front();
+				}
+
+				FinishAsyncLoad(*load);
+				++numFinished;
+			} while (stm_ms(stm_since(startTicks)) < _budgetMs);
+
+			kaAssert(numFinished <= g_numAsyncLoadsInFlight);
+			g_numAsyncLoadsInFlight -= numFinished;
+			return numFinished;
+		}
+
+		//--------------------------------------------------------------------------------
+		bool HasAsyncLoadsInFlight()
+		{
+			return g_numAsyncLoadsInFlight > 0;
+		}
+	}
 }
\ No newline at end of file
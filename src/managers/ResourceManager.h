@@ -3,6 +3,7 @@
 #include "common.h"
 #include "ResourceIDs.h"
 
+#include <array>
 #include <vector>
 #include <string>
 #include <sokol_gfx.h>
@@ -64,6 +65,7 @@ namespace Core
 				// i.e. allocated data and soloud reference for stopping the sound.
 				_o.mData = nullptr;
 				_o.mSoloud = nullptr;
+				return *this;
 			}
 
 			SoundEffect() = default;
@@ -114,6 +116,7 @@ namespace Core
 				_o.mFilename = nullptr;
 				_o.mMemFile = nullptr;
 				_o.mSoloud = nullptr;
+				return *this;
 			}
 
 			Music() = default;
@@ -138,6 +141,7 @@ namespace Core
 			int m_width;
 			int m_height;
 			std::string m_path;
+			usize m_sizeInBytes{ 0 }; // estimated GPU memory, including mips
 		};
 
 		//-------------------------------------------------
@@ -148,7 +152,17 @@ namespace Core
 			Vec2 uv{ 0.0f, 0.0f };
 			Vec3 tangent;
 		};
-		using IndexType = uint32;
+
+		// VertexData as it's uploaded, with normal and tangent octahedral encoded into snorm16 pairs.
+		// Members are in shader attribute order, so the layout's offsets can be left to sokol.
+		struct PackedVertexData
+		{
+			Vec3 position;
+			std::array<int16, 2> normal;
+			Vec2 uv;
+			std::array<int16, 2> tangent;
+		};
+		static_assert(sizeof(PackedVertexData) == 28 && offsetof(PackedVertexData, uv) == 16 && offsetof(PackedVertexData, tangent) == 24);
 
 		//-------------------------------------------------
 		using MaterialData = main_material_t;
@@ -170,6 +184,8 @@ namespace Core
 			// for now just stores meshes, no transform tree
 			std::vector<MeshData> m_meshes;
 			std::string m_path;
+			sg_index_type m_indexType{ SG_INDEXTYPE_UINT32 }; // shared by all meshes, and must match the pipeline drawing it
+			Vec4 m_boundingSphere{}; // model space, xyz centre and w radius. Covers every mesh, for culling.
 
 #if DEBUG_TOOLS
 			std::string _traceName_vBufData;
@@ -210,6 +226,11 @@ namespace Core::Resource
 	void SetupData();
 	void Cleanup();
 
+	// Init uses block compressed material textures if the backend supports them. This overrides that, to compare the two, so must be called before anything loads.
+	void SetUseCompressedTextures(bool _use);
+	// Estimated GPU memory used by every loaded texture.
+	usize GetTotalTextureBytes();
+
 	TextureData const& GetTexture(TextureID _texture);
 	ModelData const& GetModel(ModelID _model);
 	SpriteData const& GetSprite(SpriteID _sprite);
@@ -230,4 +251,14 @@ namespace Core::Resource
 	ResourceLoadResult LoadSprite(std::string const& _path, SpriteID& o_spriteID);
 	ResourceLoadResult LoadSoundEffect(std::string const& _path, SoundEffectID& o_soundEffectID);
 	ResourceLoadResult LoadMusic(std::string const& _path, MusicID& o_musicID);
+
+	// Packs the textures of sprites loaded since the last call into shared atlas pages, and points the sprites at them.
+	// Sprites already in the render scene keep their old texture until Render::RefreshSpritesInScene.
+	void PackSpriteAtlases();
+
+	// Asynchronous loading. Files are read and decoded on loading threads, leaving only GPU uploads and registration for the main thread.
+	void QueueAsyncLoad(std::string const& _path, FileType _type);
+	// Registers decoded files until _budgetMs is used up (always at least one, if any are ready). Returns how many were finished.
+	usize FinishAsyncLoads(Vec1 _budgetMs);
+	bool HasAsyncLoadsInFlight();
 }
\ No newline at end of file
@@ -26,7 +26,11 @@ namespace Core::Sound
 	//--------------------------------------------------------------------------------
 	void Init()
 	{
+#if DRIFT_HEADLESS
+		g_soundState.soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER);
+#else
 		g_soundState.soloud.init();
+#endif
 	}
 
 	//--------------------------------------------------------------------------------
@@ -146,6 +146,41 @@ static void CubeTestEntities()
 
 }
 
+static void CubeStressEntities()
+{
+	// Stacked in layers in front of the wall. The ground's top is at y = -1.
+	constexpr int32 c_boxesPerSide{ 20 };
+	constexpr int32 c_layers{ 10 };
+	constexpr Vec1 c_spacing{ 1.5f };
+	for (int32 layer = 0; layer < c_layers; ++layer)
+	{
+		for (int32 x = 0; x < c_boxesPerSide; ++x)
+		{
+			for (int32 z = 0; z < c_boxesPerSide; ++z)
+			{
+				Core::EntityID box = Core::CreateEntity();
+				Trans const boxTrans{ Identity<Quat>(), Vec3(-15.0f + x * c_spacing, 2.0f + layer * c_spacing, -35.0f + z * c_spacing) };
+				Core::AddComponent(box, Core::Transform3D(boxTrans));
+				{
+					Core::Render::ModelDesc modelDesc{};
+					modelDesc.m_filePath = "assets/models/cube/bluecube.obj";
+					Core::AddComponent(box, modelDesc);
+				}
+				{
+					Core::Physics::RigidBodyDesc rbDesc{};
+					rbDesc.m_shapeType = Core::Physics::ShapeType::Box;
+					rbDesc.m_boxHalfDimensions = Vec3(0.5f, 0.5f, 0.5f);
+					rbDesc.m_mass = 10.0f;
+					rbDesc.m_startTransform = boxTrans;
+					rbDesc.m_physicsWorld = Core::Physics::GetPrimaryWorldEntity();
+
+					Core::AddComponent(box, rbDesc);
+				}
+			}
+		}
+	}
+}
+
 void CubeTestSystems()
 {
 	Core::MakeSystem<Sys::GAME>([](Core::FrameData const& _fd, CubeTest& _cubeTest, Core::Transform3D& _t)
@@ -154,14 +189,14 @@ void CubeTestSystems()
 		{
 			_cubeTest.rx += _fd.dt;
 			_cubeTest.ry = sin(_cubeTest.rx);
-			_t.T().m_origin.x = 0.0f;
-			_t.T().m_basis = glm::yawPitchRoll(_cubeTest.rx, 0.0f, 0.0f);
+			_t.Modify().m_origin.x = 0.0f;
+			_t.Modify().m_basis = glm::yawPitchRoll(_cubeTest.rx, 0.0f, 0.0f);
 		}
 		else
 		{
 			_cubeTest.rx -= 1.0f * _fd.dt;
 			_cubeTest.ry -= 2.0f * _fd.dt;
-			_t.T().m_basis = glm::yawPitchRoll(0.0f, _cubeTest.rx, _cubeTest.ry);
+			_t.Modify().m_basis = glm::yawPitchRoll(0.0f, _cubeTest.rx, _cubeTest.ry);
 		}
 	});
 
@@ -171,7 +206,7 @@ void CubeTestSystems()
 		n += _fd.dt * 0.5f;
 		if (_light.m_type == Core::Render::Light::Type::Directional)
 		{
-			_t.T().m_basis = RotationFromForward(Vec3(cos(n), sin(n), 1.0f));
+			_t.Modify().m_basis = RotationFromForward(Vec3(cos(n), sin(n), 1.0f));
 		}
 	});
 }
@@ -203,4 +238,10 @@ namespace Game::Scene
 
 		CubeTestEntities();
 	}
+
+	void CubeStressScene::Setup()
+	{
+		CubeTestScene::Setup();
+		CubeStressEntities();
+	}
 }
\ No newline at end of file
@@ -14,4 +14,13 @@ namespace Game::Scene
 
 		void Setup() override;
 	};
+
+	// CubeTest with thousands of boxes dropped on the ground, for timing physics.
+	class CubeStressScene : public CubeTestScene
+	{
+	public:
+		~CubeStressScene() override {}
+
+		void Setup() override;
+	};
 }
\ No newline at end of file
@@ -58,11 +58,11 @@ void GinRummy::Setup()
 		cardie.m_dir = Normalise( Vec2{ dist( rng ), dist( rng ) } );
 
 		Core::Transform2D trans;
-		trans.m_transform.m_z = ( Vec1 )i / N;
+		trans.Modify().m_z = ( Vec1 )i / N;
 
 		Core::Render::SpriteDesc sprite;
 		sprite.m_spriteInit = cardieSprites[ i % 52 ];
-		sprite.m_initTrans = trans.m_transform;
+		sprite.m_initTrans = trans.T();
 
 		Core::EntityID const cardieEntity = Core::CreateEntity();
 		Core::AddComponent( cardieEntity, cardie );
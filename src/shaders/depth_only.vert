@@ -1,11 +1,18 @@
 //#version 330
 in vec3 aPos;
 
+// instance data, shared with the main pass
+in vec4 aViewModel0;
+in vec4 aViewModel1;
+in vec4 aViewModel2;
+in vec4 aViewModel3;
+
 uniform vs_params {
-    mat4 projViewModel;
+    mat4 viewToLightSpace;
 };
 
 void main()
 {
-    gl_Position = projViewModel * vec4(aPos, 1.0);
+    mat4 viewModel = mat4(aViewModel0, aViewModel1, aViewModel2, aViewModel3);
+    gl_Position = viewToLightSpace * viewModel * vec4(aPos, 1.0);
 } 
\ No newline at end of file
@@ -1,17 +1,21 @@
 //#version 330
 in vec3 aPos;
-in vec3 aNormal;
+in vec2 aNormal; // octahedral encoded
 in vec2 aTexCoord;
-in vec3 aTangent;
+in vec2 aTangent; // octahedral encoded
+
+// instance data
+in vec4 aViewModel0;
+in vec4 aViewModel1;
+in vec4 aViewModel2;
+in vec4 aViewModel3;
+in vec3 aNormalMatrix0;
+in vec3 aNormalMatrix1;
+in vec3 aNormalMatrix2;
 
 uniform vs_params {
     mat4 projection;
-};
-
-uniform model_params {
-    mat4 viewModel;
-    mat4 normal;
-    mat4 lightSpace;
+    mat4 viewToLightSpace;
 };
 
 out vec3 FragPos;
@@ -19,15 +23,29 @@ out vec2 TexCoord;
 out vec4 FragPosLightSpace;
 out mat3 TBN;
 
+vec3 OctDecode(vec2 e)
+{
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+    {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+}
+
 void main()
 {
-    FragPos = vec3(viewModel * vec4(aPos, 1.0));
+    mat4 viewModel = mat4(aViewModel0, aViewModel1, aViewModel2, aViewModel3);
+    mat3 normal = mat3(aNormalMatrix0, aNormalMatrix1, aNormalMatrix2);
+
+    vec4 viewPos = viewModel * vec4(aPos, 1.0);
+    FragPos = vec3(viewPos);
     TexCoord = aTexCoord;
-    FragPosLightSpace = lightSpace * vec4(aPos, 1.0);
-    vec3 Normal = normalize(vec3(normal * vec4(aNormal, 0.0)));
-    vec3 Tangent = normalize(vec3(normal * vec4(aTangent, 0.0)));
+    FragPosLightSpace = viewToLightSpace * viewPos;
+    vec3 Normal = normalize(normal * OctDecode(aNormal));
+    vec3 Tangent = normalize(normal * OctDecode(aTangent));
     vec3 Bitangent = normalize(cross(Normal, Tangent));
     TBN = mat3(Tangent, Bitangent, Normal);
 
-    gl_Position = projection * viewModel * vec4(aPos, 1.0);
+    gl_Position = projection * viewPos;
 } 
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 // All stb-style implementations should be defined in this file
 
+#if DRIFT_HEADLESS
+// sokol_app has no dummy backend, so only its declarations are wanted. See HeadlessApp.cpp.
+#include <sokol_app.h>
+#endif
+
 #define SOKOL_IMPL
 #define SOKOL_ASSERT(c) SOKOL_GENERAL_ASSERT(c)
 #if DEBUG_TOOLS
@@ -9,9 +14,13 @@
 #else
 	#define DISABLE_GL_ERROR
 #endif
+#if !DRIFT_HEADLESS
 #include <sokol_app.h>
+#endif
 #include <sokol_gfx.h>
+#if !DRIFT_HEADLESS
 #include <sokol_glue.h>
+#endif
 #include <sokol_time.h>
 // sokol fetch doesn't need to be on main thread.
 #undef SOKOL_ASSERT
@@ -22,6 +31,8 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
 
 #include <imgui.h>
 #define SOKOL_IMGUI_IMPL
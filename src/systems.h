@@ -6,10 +6,12 @@
 // Core
 #include "systems/Core/ImGuiSystems.h"
 #include "systems/Core/PhysicsSystems.h"
+#include "systems/Core/ProfilingSystems.h"
 #include "systems/Core/RenderSystems.h"
 #include "systems/Core/ResourceSystems.h"
 #include "systems/Core/SoundSystems.h"
 #include "systems/Core/TextAndGLDebugSystems.h"
+#include "systems/Core/TransformSystems.h"
 
 // Game
 #include "systems/Game/PlayerSystems.h"
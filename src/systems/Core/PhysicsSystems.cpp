@@ -2,10 +2,17 @@
 
 #include "components.h"
 #include "managers/InputManager.h"
+#include "systems/Core/ProfilingSystems.h"
 
 #include <btBulletDynamicsCommon.h>
+#include <LinearMath/btThreads.h>
 
+#include <algorithm>
+#include <array>
+#include <execution>
 #include <memory>
+#include <numeric>
+#include <thread>
 
 #if PHYSICS_DEBUG
 #include <sokol_gfx.h>
@@ -119,8 +126,75 @@ namespace Core
 		}
 #endif
 
-		void Init()
+		// Hands bullet's parallel loops to the parallel algorithms, the same as the ecs uses for parallel systems, rather than bullet's own thread pool.
+		// Each loop is split into at most one chunk per thread. libstdc++ only runs these in parallel with TBB, which CMake links on Linux.
+		class TaskScheduler : public btITaskScheduler
 		{
+			int m_numThreads{ 1 };
+
+			template<typename T_Fn>
+			void RunChunks(int _begin, int _end, int _grainSize, T_Fn const& _fnRunChunk) const
+			{
+				int const count = _end - _begin;
+				int const numChunks = std::clamp((count + _grainSize - 1) / std::max(_grainSize, 1), 1, m_numThreads);
+
+				std::array<int, BT_MAX_THREAD_COUNT> chunks;
+				std::iota(chunks.begin(), chunks.begin() + numChunks, 0);
+				std::for_each(std::execution::par, chunks.begin(), chunks.begin() + numChunks, [&](int _chunkI)
+				{
+					_fnRunChunk(_chunkI, _begin + count * _chunkI / numChunks, _begin + count * (_chunkI + 1) / numChunks);
+				});
+			}
+
+		public:
+			TaskScheduler()
+				: btITaskScheduler("drift")
+				, m_numThreads{ GetHardwareThreads() }
+			{}
+
+			static int GetHardwareThreads()
+			{
+				return std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, BT_MAX_THREAD_COUNT);
+			}
+
+			// Bullet sizes its per-thread data by this and indexes it by btGetCurrentThreadIndex, which counts every thread that's ever run a task.
+			// The parallel algorithms don't promise to stay on hardware-thread-many threads, so allow for as many as bullet can.
+			int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+			int getNumThreads() const override { return m_numThreads; }
+			void setNumThreads(int _numThreads) override { m_numThreads = std::clamp(_numThreads, 1, GetHardwareThreads()); }
+
+			void parallelFor(int _begin, int _end, int _grainSize, btIParallelForBody const& _body) override
+			{
+				RunChunks(_begin, _end, _grainSize, [&_body](int, int _chunkBegin, int _chunkEnd)
+				{
+					_body.forLoop(_chunkBegin, _chunkEnd);
+				});
+			}
+
+			btScalar parallelSum(int _begin, int _end, int _grainSize, btIParallelSumBody const& _body) override
+			{
+				std::array<btScalar, BT_MAX_THREAD_COUNT> sums{};
+				RunChunks(_begin, _end, _grainSize, [&_body, &sums](int _chunkI, int _chunkBegin, int _chunkEnd)
+				{
+					sums[_chunkI] = _body.sumLoop(_chunkBegin, _chunkEnd);
+				});
+				return std::accumulate(sums.begin(), sums.end(), btScalar(0));
+			}
+		};
+		static std::unique_ptr<TaskScheduler> g_taskScheduler;
+		static uint32 g_worldThreadCount{ 0 };
+
+		void Init
+		(
+			uint32 _numThreads
+		)
+		{
+			// Needs to be set from the main thread, which bullet takes to be the first that asks for its thread index.
+			g_taskScheduler = std::make_unique<TaskScheduler>();
+			g_taskScheduler->setNumThreads(_numThreads > 0 ? static_cast<int>(_numThreads) : BT_MAX_THREAD_COUNT);
+			g_worldThreadCount = _numThreads;
+			btSetTaskScheduler(g_taskScheduler.get());
+
 #if PHYSICS_DEBUG
 
 			btIDebugDraw::DefaultColors colours;
@@ -292,12 +366,28 @@ namespace Core
 
 			Core::MakeSystem<Sys::PHYSICS_TRANSFORMS_OUT>([](Core::Physics::CharacterController const& _cc, Core::Transform3D& _t)
 			{
-				btTransform trans;
-				_cc.m_body->getMotionState()->getWorldTransform(trans);
-				_t.SetLocalTransformFromWorldTransform(Trans(trans));
+				Vec1 const interpolation = GetWorld(_cc.m_physicsWorld).m_interpolation;
+				_t.SetLocalTransformFromWorldTransform(Trans(_cc.m_motionState->Interpolate(interpolation)));
 			});
 		}
 
+		static void BeginStep
+		(
+			Core::Physics::World& io_pw
+		)
+		{
+			btCollisionObjectArray& objects = io_pw.m_dynamicsWorld->getCollisionObjectArray();
+			for (int objectI = 0; objectI < objects.size(); ++objectI)
+			{
+				btRigidBody* const body = btRigidBody::upcast(objects[objectI]);
+				// Every body made through AddComponent has an InterpolatedMotionState.
+				if (body != nullptr && !body->isStaticOrKinematicObject() && body->getMotionState() != nullptr)
+				{
+					static_cast<InterpolatedMotionState*>(body->getMotionState())->BeginStep();
+				}
+			}
+		}
+
 		void Setup()
 		{
 			AddCharacterControllerSystems();
@@ -309,8 +399,8 @@ namespace Core
 				// Can't set transforms for non-kinematic bodies.
 				if (_rb.m_body->isKinematicObject())
 				{
-					Trans const worldTrans = _t.CalculateWorldTransform();
-					_rb.m_motionState->setWorldTransform(worldTrans.GetBulletTransform());
+					Trans const& worldTrans = _t.GetWorldTransform();
+					_rb.m_motionState->Reset(worldTrans.GetBulletTransform());
 				}
 			});
 
@@ -322,7 +412,19 @@ namespace Core
 #endif 
 				Core::FrameData const& _fd, Core::Physics::World& _pw)
 			{
-				_pw.m_dynamicsWorld->stepSimulation(_fd.dt, 10);
+				Core::Profiling::Scope const profileScope{ "stepSimulation" };
+				_pw.m_accumulatedTime += _fd.dt;
+				uint32 numSteps{ 0 };
+				while (_pw.m_accumulatedTime >= _pw.m_fixedStep && numSteps < _pw.m_maxStepsPerFrame)
+				{
+					BeginStep(_pw);
+					// With no substeps bullet takes exactly one step of the given length, and leaves motion states on the stepped transform.
+					_pw.m_dynamicsWorld->stepSimulation(_pw.m_fixedStep, 0);
+					_pw.m_accumulatedTime -= _pw.m_fixedStep;
+					++numSteps;
+				}
+				_pw.m_accumulatedTime = std::min(_pw.m_accumulatedTime, _pw.m_fixedStep);
+				_pw.m_interpolation = _pw.m_accumulatedTime / _pw.m_fixedStep;
 #if PHYSICS_DEBUG
 				for (ImGuiWorldData const& world : g_imGuiData.physicsWorlds)
 				{
@@ -364,17 +466,8 @@ namespace Core
 			{
 				if (_rb.m_body->isActive())
 				{
-					btTransform trans;
-					if (_rb.m_body->getMotionState())
-					{
-						_rb.m_body->getMotionState()->getWorldTransform(trans);
-					}
-					else
-					{
-						trans = _rb.m_body->getWorldTransform();
-					}
-
-					_t.SetLocalTransformFromWorldTransform(Trans(trans));
+					Vec1 const interpolation = GetWorld(_rb.m_physicsWorld).m_interpolation;
+					_t.SetLocalTransformFromWorldTransform(Trans(_rb.m_motionState->Interpolate(interpolation)));
 
 #if PHYSICS_DEBUG
 					if(g_imGuiData.showRBAxes)
@@ -395,6 +488,18 @@ namespace Core
 #if PHYSICS_DEBUG
 			g_debugDrawer.reset();
 #endif
+			btSetTaskScheduler(nullptr);
+			g_taskScheduler.reset();
+		}
+
+		btITaskScheduler* GetTaskScheduler()
+		{
+			return g_taskScheduler.get();
+		}
+
+		uint32 GetWorldThreadCount()
+		{
+			return g_worldThreadCount;
 		}
 }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "common.h"
 
 class btIDebugDraw;
+class btITaskScheduler;
 
 #define PHYSICS_DEBUG DEBUG_TOOLS
 
@@ -11,10 +12,16 @@ namespace Core
 {
 	namespace Physics
 	{
-		void Init();
+		// _numThreads is how many threads multithreaded worlds split their work across, 0 for every hardware thread.
+		void Init(uint32 _numThreads);
 		void Setup();
 		void Cleanup();
 
+		// Runs bullet's parallel work for multithreaded worlds.
+		btITaskScheduler* GetTaskScheduler();
+		// The count given to Init, which every multithreaded world's m_numThreads must match.
+		uint32 GetWorldThreadCount();
+
 #if PHYSICS_DEBUG
 		namespace Debug
 		{
@@ -0,0 +1,346 @@
+#include "ProfilingSystems.h"
+
+#include "components.h"
+
+#include "managers/EntityManager.h"
+
+#include "common/Mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <sokol_time.h>
+
+#if DEBUG_TOOLS
+#include <imgui.h>
+
+#include "systems/Core/ImGuiSystems.h"
+#endif
+
+namespace Core
+{
+	namespace Profiling
+	{
+		// A group's time runs from its marker system to the next group's marker, or to FrameEnd for the last group.
+		// Markers are made before anything else, so they're usually the first system in their group to run, but this isn't guaranteed
+		// with parallel systems, so treat the split between neighbouring groups as approximate.
+		static std::array<uint64, Sys::COUNT> g_groupStartTicks{};
+		static GroupTimings g_lastFrameTimings{};
+		static GroupTimings g_totalTimings{};
+		static uint64 g_totalFrameCount{ 0 };
+
+		// Rolling window for the panel's averages and percentiles.
+		static constexpr usize c_historyFrames{ 240 };
+		static std::array<GroupTimings, c_historyFrames> g_history{};
+		static usize g_historyNext{ 0 };
+		static usize g_historyCount{ 0 };
+
+		struct Event
+		{
+			char const* m_name;
+			uint64 m_startTicks;
+			uint64 m_endTicks;
+		};
+
+		// Only ever pushed to by its own thread and drained by FrameEnd on the main thread, so a single producer single consumer ring
+		// does without locks. Events are dropped if the ring fills up between drains.
+		struct ThreadEvents
+		{
+			static constexpr uint32 c_capacity{ 4096 };
+
+			std::array<Event, c_capacity> m_events;
+			std::atomic<uint32> m_head{ 0 }; // only written by the owning thread
+			std::atomic<uint32> m_tail{ 0 }; // only written by FrameEnd
+			uint32 m_traceThreadID{ 0 };
+		};
+
+		// Only locked when a thread pushes its first event, and by FrameEnd.
+		static Mutex< std::vector<std::unique_ptr<ThreadEvents>> > g_threadEvents;
+
+		static ThreadEvents& GetThreadEvents()
+		{
+			thread_local ThreadEvents* t_events{ nullptr };
+			if (t_events == nullptr)
+			{
+				auto eventsAccess = g_threadEvents.Write();
+				t_events = eventsAccess->emplace_back(std::make_unique<ThreadEvents>()).get();
+				// tid 0 is kept for the group timeline.
+				t_events->m_traceThreadID = static_cast<uint32>(eventsAccess->size());
+			}
+			return *t_events;
+		}
+
+		struct TraceEvent
+		{
+			char const* m_name;
+			char const* m_category;
+			uint64 m_startTicks;
+			uint64 m_endTicks;
+			uint32 m_threadID;
+		};
+
+		struct TraceCapture
+		{
+			std::string m_path;
+			uint32 m_framesLeft{ 0 };
+			uint64 m_startTicks{ 0 };
+			std::vector<TraceEvent> m_events;
+		};
+		static TraceCapture g_trace;
+
+		//--------------------------------------------------------------------------------
+		Scope::Scope(char const* _name)
+			: m_name{ _name }
+			, m_startTicks{ stm_now() }
+		{}
+
+		//--------------------------------------------------------------------------------
+		Scope::~Scope()
+		{
+			ThreadEvents& events = GetThreadEvents();
+			uint32 const head = events.m_head.load(std::memory_order_relaxed);
+			if (head - events.m_tail.load(std::memory_order_acquire) < ThreadEvents::c_capacity)
+			{
+				events.m_events[head % ThreadEvents::c_capacity] = { m_name, m_startTicks, stm_now() };
+				events.m_head.store(head + 1, std::memory_order_release);
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		template<int32 t_Group>
+		static void MakeGroupMarker()
+		{
+			if constexpr (Sys::c_mtOnlySysOrdering[t_Group])
+			{
+				Core::MakeSerialSystem<t_Group>([](Core::MT_Only&)
+				{
+					g_groupStartTicks[t_Group] = stm_now();
+				});
+			}
+			else
+			{
+				Core::MakeSerialSystem<t_Group>([](Core::FrameData const&)
+				{
+					g_groupStartTicks[t_Group] = stm_now();
+				});
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		template<int32... t_Groups>
+		static void MakeGroupMarkers(std::integer_sequence<int32, t_Groups...>)
+		{
+			(MakeGroupMarker<t_Groups>(), ...);
+		}
+
+		//--------------------------------------------------------------------------------
+		static void WriteTrace()
+		{
+			std::ofstream file(g_trace.m_path, std::ios::trunc);
+			if (!file.is_open())
+			{
+				kaError("Couldn't open " + g_trace.m_path + " to write the profiling trace");
+				return;
+			}
+
+			file << "{\"traceEvents\":[\n";
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"System groups\"}}";
+			for (TraceEvent const& event : g_trace.m_events)
+			{
+				// trace_event wants microseconds.
+				file << std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":0,\"tid\":{}}}",
+					event.m_name,
+					event.m_category,
+					stm_us(stm_diff(event.m_startTicks, g_trace.m_startTicks)),
+					stm_us(stm_diff(event.m_endTicks, event.m_startTicks)),
+					event.m_threadID
+				);
+			}
+			file << "\n]}\n";
+
+			kaLog(std::format("Wrote {:d} profiling events to {}", g_trace.m_events.size(), g_trace.m_path));
+		}
+
+		//--------------------------------------------------------------------------------
+		static void DrainThreadEvents()
+		{
+			bool const capturing = IsCapturingTrace();
+			auto eventsAccess = g_threadEvents.Read();
+			for (std::unique_ptr<ThreadEvents> const& events : *eventsAccess)
+			{
+				uint32 const tail = events->m_tail.load(std::memory_order_relaxed);
+				uint32 const head = events->m_head.load(std::memory_order_acquire);
+				if (capturing)
+				{
+					for (uint32 i = tail; i != head; ++i)
+					{
+						Event const& event = events->m_events[i % ThreadEvents::c_capacity];
+						g_trace.m_events.push_back({ event.m_name, "scope", event.m_startTicks, event.m_endTicks, events->m_traceThreadID, });
+					}
+				}
+				events->m_tail.store(head, std::memory_order_release);
+			}
+		}
+
+#if DEBUG_TOOLS
+		static bool g_showProfiler{ false };
+		static int g_traceFrames{ 300 };
+
+		//--------------------------------------------------------------------------------
+		static void DrawProfilerWindow()
+		{
+			if (!ImGui::Begin("Frame Profiler", &g_showProfiler, 0))
+			{
+				ImGui::End();
+				return;
+			}
+
+			ImGui::Text("Over the last %u frames", static_cast<uint32>(g_historyCount));
+			if (ImGui::BeginTable("groups", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+			{
+				ImGui::TableSetupColumn("Group");
+				ImGui::TableSetupColumn("Last");
+				ImGui::TableSetupColumn("Avg");
+				ImGui::TableSetupColumn("p50");
+				ImGui::TableSetupColumn("p95");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableHeadersRow();
+
+				std::array<dVec1, c_historyFrames> sorted;
+				for (usize group = 0; group < Sys::COUNT; ++group)
+				{
+					dVec1 sum{ 0.0 };
+					for (usize i = 0; i < g_historyCount; ++i)
+					{
+						sorted[i] = g_history[i][group];
+						sum += sorted[i];
+					}
+					std::sort(sorted.begin(), sorted.begin() + g_historyCount);
+					auto const percentile = [&](dVec1 _p) { return g_historyCount > 0 ? sorted[static_cast<usize>(_p * (g_historyCount - 1))] : 0.0; };
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn(); ImGui::TextUnformatted(Sys::c_sysOrderingNames[group]);
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", g_lastFrameTimings[group]);
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", g_historyCount > 0 ? sum / g_historyCount : 0.0);
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", percentile(0.5));
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", percentile(0.95));
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", percentile(1.0));
+				}
+				ImGui::EndTable();
+			}
+
+			if (IsCapturingTrace())
+			{
+				ImGui::Text("Capturing trace, %u frames left", g_trace.m_framesLeft);
+			}
+			else
+			{
+				ImGui::InputInt("Frames", &g_traceFrames);
+				if (ImGui::Button("Capture trace") && g_traceFrames > 0)
+				{
+					CaptureTrace("profile_trace.json", static_cast<uint32>(g_traceFrames));
+				}
+			}
+			ImGui::End();
+		}
+#endif
+
+		//--------------------------------------------------------------------------------
+		void Setup()
+		{
+			MakeGroupMarkers(std::make_integer_sequence<int32, Sys::COUNT>{});
+
+#if DEBUG_TOOLS
+			Core::Render::DImGui::AddMenuItem("Profiling", "Frame Profiler", &g_showProfiler);
+
+			Core::MakeSystem<Sys::IMGUI>([](Core::MT_Only&)
+			{
+				if (g_showProfiler)
+				{
+					DrawProfilerWindow();
+				}
+			});
+#endif
+		}
+
+		//--------------------------------------------------------------------------------
+		void FrameEnd()
+		{
+			uint64 const frameEndTicks = stm_now();
+			for (usize group = 0; group < Sys::COUNT; ++group)
+			{
+				uint64 const groupEndTicks = group + 1 < Sys::COUNT ? g_groupStartTicks[group + 1] : frameEndTicks;
+				g_lastFrameTimings[group] = stm_ms(stm_diff(groupEndTicks, g_groupStartTicks[group]));
+				g_totalTimings[group] += g_lastFrameTimings[group];
+
+				if (IsCapturingTrace())
+				{
+					g_trace.m_events.push_back({ Sys::c_sysOrderingNames[group], "group", g_groupStartTicks[group], groupEndTicks, 0, });
+				}
+			}
+			++g_totalFrameCount;
+
+			g_history[g_historyNext] = g_lastFrameTimings;
+			g_historyNext = (g_historyNext + 1) % c_historyFrames;
+			g_historyCount = std::min(g_historyCount + 1, c_historyFrames);
+
+			DrainThreadEvents();
+
+			if (IsCapturingTrace() && --g_trace.m_framesLeft == 0)
+			{
+				WriteTrace();
+				g_trace.m_events.clear();
+			}
+		}
+
+		//--------------------------------------------------------------------------------
+		GroupTimings const& GetLastFrameTimings()
+		{
+			return g_lastFrameTimings;
+		}
+
+		//--------------------------------------------------------------------------------
+		GroupTimings const& GetTotalTimings()
+		{
+			return g_totalTimings;
+		}
+
+		//--------------------------------------------------------------------------------
+		uint64 GetTotalFrameCount()
+		{
+			return g_totalFrameCount;
+		}
+
+		//--------------------------------------------------------------------------------
+		void ResetTotals()
+		{
+			g_totalTimings = {};
+			g_totalFrameCount = 0;
+		}
+
+		//--------------------------------------------------------------------------------
+		void CaptureTrace
+		(
+			std::string _path,
+			uint32 _numFrames
+		)
+		{
+			kaAssert(_numFrames > 0, "capturing a trace needs at least one frame");
+			g_trace.m_path = std::move(_path);
+			g_trace.m_framesLeft = _numFrames;
+			g_trace.m_startTicks = stm_now();
+			g_trace.m_events.clear();
+		}
+
+		//--------------------------------------------------------------------------------
+		bool IsCapturingTrace()
+		{
+			return g_trace.m_framesLeft > 0;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common.h"
+#include "SystemOrdering.h"
+
+#include <array>
+#include <string>
+
+namespace Core
+{
+	namespace Profiling
+	{
+		// Milliseconds per system group, indexed by Sys::SystemOrdering.
+		using GroupTimings = std::array<dVec1, Sys::COUNT>;
+
+		// Must be called before any other systems are made, so that each group's marker is the first thing it runs.
+		void Setup();
+		// Call after the ecs update each frame, to close off the last group.
+		void FrameEnd();
+
+		GroupTimings const& GetLastFrameTimings();
+		// Summed over every frame since the last ResetTotals.
+		GroupTimings const& GetTotalTimings();
+		uint64 GetTotalFrameCount();
+		void ResetTotals();
+
+		// Times the enclosing scope on the calling thread. Cheap enough to leave in, events are only kept while a trace is being captured.
+		// _name must outlive the trace, so use string literals.
+		class Scope
+		{
+			char const* m_name;
+			uint64 m_startTicks;
+
+		public:
+			explicit Scope(char const* _name);
+			~Scope();
+
+			Scope(Scope const&) = delete;
+			Scope& operator=(Scope const&) = delete;
+		};
+
+		// Records every group and Scope event for the next _numFrames frames, then writes them to _path in Chrome trace_event JSON
+		// (load it in chrome://tracing or Perfetto).
+		void CaptureTrace(std::string _path, uint32 _numFrames);
+		bool IsCapturingTrace();
+	}
+}
\ No newline at end of file
@@ -5,10 +5,42 @@
 #include "managers/RenderManager.h"
 #include "managers/InputManager.h"
 
+#if DEBUG_TOOLS
+#include <imgui.h>
+
+#include "systems/Core/ImGuiSystems.h"
+#endif
+
 namespace Core
 {
 	namespace Render
 	{
+#if DEBUG_TOOLS
+		static bool g_showFrameStats{ false };
+
+		//--------------------------------------------------------------------------------
+		static void DrawFrameStatsWindow()
+		{
+			if (ImGui::Begin("Render Stats", &g_showFrameStats, 0))
+			{
+				FrameStats const& stats = GetFrameStats();
+				ImGui::Text("Draw calls: %zu", stats.m_drawCalls);
+				ImGui::Text("Uniform applies: %zu", stats.m_uniformApplies);
+				ImGui::Text("Bindings applied: %zu", stats.m_bindingsApplied);
+				ImGui::Text("Pass switches: %zu", stats.m_passSwitches);
+				ImGui::Text("Uploaded: %.1f KB", static_cast<dVec1>(stats.m_bytesUploaded) / 1024.0);
+				ImGui::Text("Vertices: %zu", stats.m_verticesSubmitted);
+				ImGui::Text("Indices: %zu", stats.m_indicesSubmitted);
+				ImGui::Text("Sprite batches: %zu", stats.m_spriteBatches);
+				ImGui::Separator();
+				ImGui::Text("Meshes queued: %zu", stats.m_submittedMeshes);
+				ImGui::Text("Shadow meshes drawn: %zu", stats.m_shadowMeshesDrawn);
+				ImGui::Text("Main meshes drawn: %zu", stats.m_mainMeshesDrawn);
+			}
+			ImGui::End();
+		}
+#endif
+
 		void Setup()
 		{
 			Core::MakeSystem<Sys::RENDER_QUEUE>([](Core::Render::Light const& _light, Core::Transform3D const& _t)
@@ -27,7 +59,7 @@ namespace Core
 					LightSetter lightSetter = AddLightThisFrame();
 					lightSetter.Col = Vec4(_light.m_colour, _light.m_intensity);
 
-					Trans const worldT = _t.CalculateWorldTransform();
+					Trans const& worldT = _t.GetWorldTransform();
 					// forward() is vec/light dir.
 					Vec3 const lightDir = Normalise(Vec3((GetCameraState().view * Vec4(worldT.Forward(), 0.0f)).xyz));
 					lightSetter.Pos = Vec4(-lightDir, 0.0f);
@@ -40,7 +72,7 @@ namespace Core
 					LightSetter lightSetter = AddLightThisFrame();
 					lightSetter.Col = Vec4(_light.m_colour, _light.m_intensity);
 
-					Trans const worldT = _t.CalculateWorldTransform();
+					Trans const& worldT = _t.GetWorldTransform();
 					Vec3 const lightPos = (GetCameraState().view * Vec4(worldT.m_origin, 1.0f)).xyz;
 					lightSetter.Pos = Vec4(lightPos, 1.0f);
 
@@ -56,7 +88,7 @@ namespace Core
 					LightSetter lightSetter = AddLightThisFrame();
 					lightSetter.Col = Vec4(_light.m_colour, _light.m_intensity);
 
-					Trans const worldT = _t.CalculateWorldTransform();
+					Trans const& worldT = _t.GetWorldTransform();
 					Vec3 const lightPos = (GetCameraState().view * Vec4(worldT.m_origin, 1.0f)).xyz;
 					lightSetter.Pos = Vec4(lightPos, 1.0f);
 
@@ -77,7 +109,7 @@ namespace Core
 			{
 				if (_model.m_drawDefaultPass)
 				{
-					DrawModelThisFrame(_model.m_modelID, _t.CalculateWorldTransform());
+					DrawModelThisFrame(_model.m_modelID, _t.GetWorldTransform());
 				}
 			});
 
@@ -88,7 +120,7 @@ namespace Core
 
 			Core::MakeSystem<Sys::RENDER_QUEUE>([](Core::Render::Sprite const& _sprite, Core::Transform2D const& _t)
 			{
-				UpdateSpriteInScene( _sprite.m_spriteSceneID, _t.CalculateWorldTransform(), _sprite.m_spriteFlags );
+				UpdateSpriteInScene( _sprite.m_spriteSceneID, _t.GetWorldTransform(), _sprite.m_spriteFlags );
 			});
 
 
@@ -102,24 +134,37 @@ namespace Core
 				Core::Render::Render(_rfd);
 			});
 
+#if DEBUG_TOOLS
+			// Shows the previous frame's stats, as the IMGUI group runs before RENDER.
+			Core::Render::DImGui::AddMenuItem("Render", "Render Stats", &g_showFrameStats);
+
+			Core::MakeSystem<Sys::IMGUI>([](Core::MT_Only&)
+			{
+				if (g_showFrameStats)
+				{
+					DrawFrameStatsWindow();
+				}
+			});
+#endif
+
 			//////
 			// debug camera control
-			Core::MakeSystem<Sys::GAME>([](Core::FrameData const& _fd, Core::Render::MainCamera3D& _cam, Core::Transform3D& _t, Core::Render::DebugCameraControl& _debugCamera)
+			Core::MakeSystem<Sys::GAME>([](Core::EntityID::CoreType _entity, Core::FrameData const& _fd, Core::Render::MainCamera3D& _cam, Core::Transform3D& _t, Core::Render::DebugCameraControl& _debugCamera)
 			{
 				if (Core::Input::PressedOnce(Core::Input::Action::Debug_EnableCamera))
 				{
 					if (_debugCamera.m_debugCameraEnabled)
 					{
-						_t.m_parent = _debugCamera.m_storedParent;
-						_t.T() = _debugCamera.m_storedTransform;
+						Core::SetParent3D(_entity, _debugCamera.m_storedParent);
+						_t.SetLocal(_debugCamera.m_storedTransform);
 						_debugCamera.m_debugCameraEnabled = false;
 						Core::Input::LockMouse( true );
 					}
 					else
 					{
-						_debugCamera.m_storedParent = _t.m_parent;
+						_debugCamera.m_storedParent = _t.GetParent();
 						_debugCamera.m_storedTransform = _t.T();
-						_t.DetachFromParent();
+						Core::DetachFromParent3D(_entity);
 						Vec3 const forward = _t.T().Forward();
 						_debugCamera.m_angle.x = asin(forward.y); // pitch
 						Vec1 const cosPitch = cos(_debugCamera.m_angle.x);
@@ -156,38 +201,38 @@ namespace Core
 					constexpr bool d_checkAxes = false;
 					if constexpr (d_checkAxes)
 					{
-						_t.T().m_origin = Vec3(0, 0, 0);
+						_t.Modify().m_origin = Vec3(0, 0, 0);
 						if (Core::Input::Pressed(Core::Input::Action::Forward))
 						{
-							_t.T().m_origin += Vec3(0, 0, 1);
+							_t.Modify().m_origin += Vec3(0, 0, 1);
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Backward))
 						{
-							_t.T().m_origin += Vec3(0, 0, -1);
+							_t.Modify().m_origin += Vec3(0, 0, -1);
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Left))
 						{
-							_t.T().m_origin += Vec3(-1, 0, 0);
+							_t.Modify().m_origin += Vec3(-1, 0, 0);
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Right))
 						{
-							_t.T().m_origin += Vec3(1, 0, 0);
+							_t.Modify().m_origin += Vec3(1, 0, 0);
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Debug_RaiseCamera))
 						{
-							_t.T().m_origin += Vec3(0, 1, 0);
+							_t.Modify().m_origin += Vec3(0, 1, 0);
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Debug_LowerCamera))
 						{
-							_t.T().m_origin += Vec3(0, -1, 0);
+							_t.Modify().m_origin += Vec3(0, -1, 0);
 						}
 
 						if (Core::Input::PressedOnce(Core::Input::Action::Select))
 						{
 							Vec3 const col0 = _t.T().m_basis[0];
-							_t.T().m_basis[0] = _t.T().m_basis[1];
-							_t.T().m_basis[1] = _t.T().m_basis[2];
-							_t.T().m_basis[2] = col0;
+							_t.Modify().m_basis[0] = _t.T().m_basis[1];
+							_t.Modify().m_basis[1] = _t.T().m_basis[2];
+							_t.Modify().m_basis[2] = col0;
 						}
 					}
 					else
@@ -199,7 +244,7 @@ namespace Core
 
 						Vec3 const forward = Normalise(Vec3{ cosf(yaw) * cosf(pitch), sinf(pitch), sinf(yaw) * cosf(pitch) });
 
-						_t.T().m_basis = RotationFromForward(forward);
+						_t.Modify().m_basis = RotationFromForward(forward);
 
 						// also re-calculate the Right and Up vector
 						Vec3 const right = Normalise(glm::cross(forward, Vec3(0.0f, 1.0f, 0.0f)));  // normalize the vectors, because their length gets closer to 0 the more you look up or down which results in slower movement.
@@ -208,28 +253,28 @@ namespace Core
 						Vec1 const velocity = 0.8f * _fd.unscaled_dt;
 						if (Core::Input::Pressed(Core::Input::Action::Forward))
 						{
-							_t.T().m_origin += forward * velocity;
+							_t.Modify().m_origin += forward * velocity;
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Backward))
 						{
-							_t.T().m_origin -= forward * velocity;
+							_t.Modify().m_origin -= forward * velocity;
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Left))
 						{
-							_t.T().m_origin -= right * velocity;
+							_t.Modify().m_origin -= right * velocity;
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Right))
 						{
-							_t.T().m_origin += right * velocity;
+							_t.Modify().m_origin += right * velocity;
 						}
 						// should this up really be used? or world up?
 						if (Core::Input::Pressed(Core::Input::Action::Debug_RaiseCamera))
 						{
-							_t.T().m_origin += up * velocity;
+							_t.Modify().m_origin += up * velocity;
 						}
 						if (Core::Input::Pressed(Core::Input::Action::Debug_LowerCamera))
 						{
-							_t.T().m_origin -= up * velocity;
+							_t.Modify().m_origin -= up * velocity;
 						}
 					}
 				}
@@ -3,6 +3,7 @@
 #include "components.h"
 
 #include "managers/EntityManager.h"
+#include "managers/RenderManager.h"
 #include "managers/ResourceManager.h"
 
 #include <absl/container/inlined_vector.h>
@@ -10,10 +11,13 @@
 #include <absl/container/flat_hash_map.h>
 
 #include <fstream>
+#include <format>
+
+#include <sokol_time.h>
 
 namespace Core::Resource
 {
-	static void FillFilesToLoad
+	void FillFilesToLoad
 	(
 		std::string _firstResFile,
 		std::vector<Core::Resource::Preload::FileToLoad>& o_files
@@ -116,6 +120,13 @@ namespace Core::Resource
 			case FillFilesList:
 			{
 				FillFilesToLoad( _preload.m_firstResFile.value_or( "assets/preload.res" ), _preload.m_filesToLoad );
+				for (Preload::FileToLoad const& file : _preload.m_filesToLoad)
+				{
+					QueueAsyncLoad(file.m_filePath, file.m_fileType);
+				}
+#if DEBUG_TOOLS
+				_preload.m_debug_startTicks = stm_now();
+#endif
 				_preload.m_preloadState = Preload::State::Loading;
 				// skip another frame
 				return;
@@ -126,59 +137,18 @@ namespace Core::Resource
 			}
 			}
 
-			if (_preload.m_currentLoadingIndex == _preload.m_filesToLoad.size())
-			{
-				Core::RemoveComponent<Core::Resource::Preload>(_entity);
-				return;
-			}
+			_preload.m_currentLoadingIndex += FinishAsyncLoads(c_preloadFinishBudgetMs);
 
-			// load next file
-			std::string const& nextFilePath = _preload.m_filesToLoad[_preload.m_currentLoadingIndex].m_filePath;
-
-			bool success{ false };
-			switch (_preload.m_filesToLoad[_preload.m_currentLoadingIndex].m_fileType)
-			{
-				using enum Preload::FileType;
-
-			case Model:
-			{
-				ModelID modelID;
-				success = LoadModel(nextFilePath, modelID);
-				break;
-			}
-			case Texture2D:
+			if (!HasAsyncLoadsInFlight())
 			{
-				TextureID textureID;
-				success = Load2DTexture(nextFilePath, textureID, TextureData::Type::General2D);
-				break;
-			}
-			case Cubemap:
-			{
-				TextureID cubemapID;
-				success = LoadCubemap(nextFilePath, cubemapID);
-				break;
-			}
-			case Sprite:
-			{
-				SpriteID spriteID;
-				success = LoadSprite(nextFilePath, spriteID);
-				break;
-			}
-			case SFX:
-			{
-				SoundEffectID sfxID;
-				success = LoadSoundEffect(nextFilePath, sfxID);
-				break;
-			}
-			case BGM:
-			{
-				MusicID bgmID;
-				success = LoadMusic(nextFilePath, bgmID);
-				break;
-			}
+				PackSpriteAtlases();
+				// the scene may have added sprites from the preload before it finished
+				Core::Render::RefreshSpritesInScene();
+#if DEBUG_TOOLS
+				kaLog(std::format("Preloaded {:d} files in {:.3f}ms", _preload.m_filesToLoad.size(), stm_ms(stm_since(_preload.m_debug_startTicks))));
+#endif
+				Core::RemoveComponent<Core::Resource::Preload>(_entity);
 			}
-
-			_preload.m_currentLoadingIndex++;
 		});
 	}
 }
\ No newline at end of file
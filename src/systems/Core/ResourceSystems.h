@@ -1,8 +1,18 @@
 #pragma once
 
 #include "common.h"
+#include "components/Core/ResourceComponents.h"
+
+#include <string>
+#include <vector>
 
 namespace Core::Resource
 {
 	void Setup();
+
+	// Main thread time per frame spent registering decoded files, so the loading screen keeps drawing.
+	inline constexpr Vec1 c_preloadFinishBudgetMs{ 4.0f };
+
+	// Follows the .res lists from _firstResFile and appends every asset they name.
+	void FillFilesToLoad(std::string _firstResFile, std::vector<Preload::FileToLoad>& o_files);
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "TransformSystems.h"
+
+#include "components.h"
+
+namespace Core
+{
+	// Parents are always updated before their children, and a transform is only recalculated if it or an ancestor changed since the last pass.
+	// Subtrees with nothing dirty in them aren't walked at all. _parentWorld is null for roots.
+	// Children come from the entity manager's hierarchy without locking, which is fine as nothing reparents during the world transform groups.
+	// Returns true if a child couldn't be updated yet because its component is still waiting to be committed, so the subtree needs walking again next pass.
+	bool UpdateWorldTransforms3D
+	(
+		Core::EntityID _entity,
+		Transform3D& io_transform,
+		Trans const* _parentWorld,
+		bool _parentChanged
+	)
+	{
+		bool const changed = _parentChanged || io_transform.m_dirty;
+		if (changed)
+		{
+			io_transform.m_worldTransform = _parentWorld != nullptr ? *_parentWorld * io_transform.m_transform : io_transform.m_transform;
+			io_transform.m_dirty = false;
+		}
+
+		if (!changed && !io_transform.m_descendantDirty)
+		{
+			return false;
+		}
+
+		bool pendingDescendant{ false };
+		for (Core::EntityID const child : EntityManagement::ViewChildrenUnlocked(_entity))
+		{
+			// the hierarchy is shared with 2D transforms, and children added this frame won't have their components yet.
+			Transform3D* const childTransform = Core::GetComponent<Transform3D>(child);
+			if (childTransform != nullptr)
+			{
+				if (childTransform->GetParent() == _entity)
+				{
+					pendingDescendant |= UpdateWorldTransforms3D(child, *childTransform, &io_transform.m_worldTransform, changed);
+				}
+			}
+			else if (Core::GetComponent<Transform2D>(child) == nullptr)
+			{
+				pendingDescendant = true;
+			}
+		}
+
+		io_transform.m_descendantDirty = pendingDescendant;
+		return pendingDescendant;
+	}
+
+	bool UpdateWorldTransforms2D
+	(
+		Core::EntityID _entity,
+		Transform2D& io_transform,
+		Trans2D const* _parentWorld,
+		bool _parentChanged
+	)
+	{
+		bool const changed = _parentChanged || io_transform.m_dirty;
+		if (changed)
+		{
+			io_transform.m_worldTransform = _parentWorld != nullptr ? *_parentWorld * io_transform.m_transform : io_transform.m_transform;
+			io_transform.m_dirty = false;
+		}
+
+		if (!changed && !io_transform.m_descendantDirty)
+		{
+			return false;
+		}
+
+		bool pendingDescendant{ false };
+		for (Core::EntityID const child : EntityManagement::ViewChildrenUnlocked(_entity))
+		{
+			Transform2D* const childTransform = Core::GetComponent<Transform2D>(child);
+			if (childTransform != nullptr)
+			{
+				if (childTransform->GetParent() == _entity)
+				{
+					pendingDescendant |= UpdateWorldTransforms2D(child, *childTransform, &io_transform.m_worldTransform, changed);
+				}
+			}
+			else if (Core::GetComponent<Transform3D>(child) == nullptr)
+			{
+				pendingDescendant = true;
+			}
+		}
+
+		io_transform.m_descendantDirty = pendingDescendant;
+		return pendingDescendant;
+	}
+
+	namespace Transforms
+	{
+		void Setup()
+		{
+			// Runs in parallel over roots, each walking its own subtree. Children are skipped here as their parent visits them.
+			auto const updateRoots3D = [](Core::EntityID::CoreType _entity, Core::Transform3D& _t)
+			{
+				if (_t.GetParent().IsNull())
+				{
+					UpdateWorldTransforms3D(_entity, _t, nullptr, false);
+				}
+			};
+
+			auto const updateRoots2D = [](Core::EntityID::CoreType _entity, Core::Transform2D& _t)
+			{
+				if (_t.GetParent().IsNull())
+				{
+					UpdateWorldTransforms2D(_entity, _t, nullptr, false);
+				}
+			};
+
+			// Once before anything is queued for rendering, and again after the game update so physics sees what was moved.
+			Core::MakeSystem<Sys::WORLD_TRANSFORMS>(updateRoots3D);
+			Core::MakeSystem<Sys::WORLD_TRANSFORMS>(updateRoots2D);
+			Core::MakeSystem<Sys::PHYSICS_WORLD_TRANSFORMS>(updateRoots3D);
+		}
+	}
+}
\ No newline at end of file
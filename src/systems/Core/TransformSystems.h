@@ -0,0 +1,11 @@
+#pragma once
+
+#include "common.h"
+
+namespace Core
+{
+	namespace Transforms
+	{
+		void Setup();
+	}
+}
\ No newline at end of file
@@ -1020,25 +1020,26 @@ void Setup()
 			Core::Transform2D& _trans
 		)
 		{
-			_trans.T().m_pos += 200.0f * _fd.dt * _cardie.m_dir;
-			if ( _trans.T().m_pos.x <= 0 )
+			Trans2D& trans = _trans.Modify(); // always moving
+			trans.m_pos += 200.0f * _fd.dt * _cardie.m_dir;
+			if ( trans.m_pos.x <= 0 )
 			{
-				_trans.T().m_pos.x = 0;
+				trans.m_pos.x = 0;
 				_cardie.m_dir.x = -_cardie.m_dir.x;
 			}
-			if ( _trans.T().m_pos.x >= _rfd.renderArea.f.x )
+			if ( trans.m_pos.x >= _rfd.renderArea.f.x )
 			{
-				_trans.T().m_pos.x = _rfd.renderArea.f.x;
+				trans.m_pos.x = _rfd.renderArea.f.x;
 				_cardie.m_dir.x = -_cardie.m_dir.x;
 			}
-			if ( _trans.T().m_pos.y <= 0 )
+			if ( trans.m_pos.y <= 0 )
 			{
-				_trans.T().m_pos.y = 0;
+				trans.m_pos.y = 0;
 				_cardie.m_dir.y = -_cardie.m_dir.y;
 			}
-			if ( _trans.T().m_pos.y >= _rfd.renderArea.f.y )
+			if ( trans.m_pos.y >= _rfd.renderArea.f.y )
 			{
-				_trans.T().m_pos.y = _rfd.renderArea.f.y;
+				trans.m_pos.y = _rfd.renderArea.f.y;
 				_cardie.m_dir.y = -_cardie.m_dir.y;
 			}
 		}
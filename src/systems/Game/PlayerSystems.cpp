@@ -42,7 +42,7 @@ namespace Game
 			forward.z = gcem::sin(glm::radians(_p.m_yaw)) * gcem::cos(glm::radians(_p.m_pitch));
 			forward = Normalise(forward);
 
-			_t.T().m_basis = RotationFromForward(forward);
+			_t.Modify().m_basis = RotationFromForward(forward);
 		}
 
 		void Setup()